@@ -1,31 +1,46 @@
 // CardShader.hlsl
 
-cbuffer CardConstantsBuffer : register(b0)
+// This must match RenderCommandList::CardInstance.
+struct CardInstance
 {
-    float4x4 objToProj;
-    float pad[192];
+    float2 position;
+    float2 size;
+    uint textureIndex;
+    uint3 pad;
+};
+
+cbuffer ViewConstants : register(b0)
+{
+    float4x4 worldToProj;
+    uint firstInstance;
 };
 
 struct PSInput
 {
     float4 position : SV_POSITION;
     float2 uv : TEXCOORD;
+    nointerpolation uint textureIndex : TEXTURE_INDEX;
 };
 
-Texture2D cardTexture : register(t0);
+Texture2DArray cardTextures : register(t0);
+StructuredBuffer<CardInstance> cardInstances : register(t1);
 SamplerState cardSampler : register(s0);
 
-PSInput VSMain(float4 position : POSITION, float2 uv : TEXCOORD)
+PSInput VSMain(float4 position : POSITION, float2 uv : TEXCOORD, uint instanceID : SV_InstanceID)
 {
+    CardInstance instance = cardInstances[firstInstance + instanceID];
+
     PSInput output;
-    
-    output.position = mul(objToProj, position);
+
+    float2 worldPosition = instance.position + position.xy * instance.size;
+    output.position = mul(worldToProj, float4(worldPosition, position.z, 1.0));
     output.uv = uv;
-    
+    output.textureIndex = instance.textureIndex;
+
     return output;
 }
 
 float4 PSMain(PSInput input) : SV_TARGET
 {
-    return cardTexture.Sample(cardSampler, input.uv);
+    return cardTextures.Sample(cardSampler, float3(input.uv, input.textureIndex));
 }
\ No newline at end of file
@@ -0,0 +1,33 @@
+#include "AllocationTracker.h"
+#include <new>
+#include <stdlib.h>
+
+// Building this into a program replaces the global operator new with one that counts every
+// allocation.  The array and non-throwing forms all come through here on their own.
+
+static struct AllocationCountingStarter
+{
+	AllocationCountingStarter()
+	{
+		AllocationTracker::StartCounting();
+	}
+} allocationCountingStarter;
+
+void* operator new(size_t size)
+{
+	AllocationTracker::RecordAllocation(size);
+	void* memory = ::malloc((size > 0) ? size : 1);
+	if (!memory)
+		throw std::bad_alloc();
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+	::free(memory);
+}
\ No newline at end of file
@@ -0,0 +1,89 @@
+#include "AllocationTracker.h"
+#include <atomic>
+
+// These are plain globals rather than function statics so that operator new can reach them
+// even while static initialization is still under way.
+static std::atomic<bool> allocationCounting(false);
+static std::atomic<uint64_t> allocationCount(0);
+static std::atomic<uint64_t> allocatedBytes(0);
+
+//----------------------------------- AllocationTracker -----------------------------------
+
+/*static*/ bool AllocationTracker::IsCounting()
+{
+	return allocationCounting.load(std::memory_order_relaxed);
+}
+
+/*static*/ uint64_t AllocationTracker::GetAllocationCount()
+{
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+/*static*/ uint64_t AllocationTracker::GetAllocatedBytes()
+{
+	return allocatedBytes.load(std::memory_order_relaxed);
+}
+
+/*static*/ void AllocationTracker::StartCounting()
+{
+	allocationCounting.store(true, std::memory_order_relaxed);
+}
+
+/*static*/ void AllocationTracker::RecordAllocation(size_t size)
+{
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+//----------------------------------- FrameAllocationReport -----------------------------------
+
+FrameAllocationReport::FrameAllocationReport()
+{
+	this->Reset();
+}
+
+/*virtual*/ FrameAllocationReport::~FrameAllocationReport()
+{
+}
+
+void FrameAllocationReport::Reset()
+{
+	this->frameStartAllocationCount = AllocationTracker::GetAllocationCount();
+	this->allocationCount = 0;
+	this->maxFrameAllocationCount = 0;
+	this->frameCount = 0;
+}
+
+void FrameAllocationReport::BeginFrame()
+{
+	this->frameStartAllocationCount = AllocationTracker::GetAllocationCount();
+}
+
+void FrameAllocationReport::EndFrame()
+{
+	uint64_t frameAllocationCount = AllocationTracker::GetAllocationCount() - this->frameStartAllocationCount;
+	this->allocationCount += frameAllocationCount;
+	if (frameAllocationCount > this->maxFrameAllocationCount)
+		this->maxFrameAllocationCount = frameAllocationCount;
+	this->frameCount++;
+}
+
+int FrameAllocationReport::GetFrameCount() const
+{
+	return this->frameCount;
+}
+
+uint64_t FrameAllocationReport::GetAllocationCount() const
+{
+	return this->allocationCount;
+}
+
+uint64_t FrameAllocationReport::GetMaxFrameAllocationCount() const
+{
+	return this->maxFrameAllocationCount;
+}
+
+double FrameAllocationReport::GetAverageFrameAllocationCount() const
+{
+	return (this->frameCount > 0) ? double(this->allocationCount) / double(this->frameCount) : 0.0;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// This counts the heap allocations made through the global operator new, so that a frame
+// can report how many it made.  Only programs that build in AllocationCounting.cpp, which
+// replaces operator new, do any counting.  Everywhere else the counts just stay at zero.
+class AllocationTracker
+{
+public:
+	static bool IsCounting();
+	static uint64_t GetAllocationCount();
+	static uint64_t GetAllocatedBytes();
+
+	// These are only for the replacement operator new to call.
+	static void StartCounting();
+	static void RecordAllocation(size_t size);
+};
+
+// This gathers the allocations made by each of a run of frames.
+class FrameAllocationReport
+{
+public:
+	FrameAllocationReport();
+	virtual ~FrameAllocationReport();
+
+	void Reset();
+	void BeginFrame();
+	void EndFrame();
+
+	int GetFrameCount() const;
+	uint64_t GetAllocationCount() const;
+	uint64_t GetMaxFrameAllocationCount() const;
+	double GetAverageFrameAllocationCount() const;
+
+private:
+	uint64_t frameStartAllocationCount;
+	uint64_t allocationCount;
+	uint64_t maxFrameAllocationCount;
+	int frameCount;
+};
\ No newline at end of file
@@ -3,11 +3,13 @@
 #include "SolitaireGames/SpiderSolitaireGame.h"
 #include "SolitaireGames/FreeCellSolitaireGame.h"
 #include "Utils.h"
+#include "AllocationTracker.h"
 #include <string>
 #include <format>
 #include <locale>
 #include <codecvt>
 #include <assert.h>
+#include <stdio.h>
 #include <windowsx.h>
 
 using namespace DirectX;
@@ -15,28 +17,23 @@ using namespace DirectX;
 Application::Application()
 {
 	this->tickCount = 0;
-	this->maxCardDrawCallsPerSwapFrame = 128;
 	this->windowHandle = NULL;
 	this->generalFenceEvent = NULL;
 	this->generalCount = 0L;
-	this->cardConstantsBufferPtr = nullptr;
 	this->worldToProj = XMMatrixIdentity();
 	this->mouseCaptured = false;
 
+	for (int i = 0; i < TICKS_PER_FPS_PROFILE; i++)
+		this->tickTimeArray[i] = 0.0;
+
 	::ZeroMemory(&this->cardVertexBufferView, sizeof(this->cardVertexBufferView));
 	::ZeroMemory(&this->viewport, sizeof(this->viewport));
 	::ZeroMemory(&this->scissorRect, sizeof(this->scissorRect));
 
-	this->worldExtents.min = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-	this->worldExtents.max = XMVectorSet(150.0f, 100.0f, 0.0f, 1.0f);
-
-	const double cardAspectRatio = 0.68870523415977961432506887052342;
-	const double cardWidth = 12.0f;
-
-	this->cardSize.min = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-	this->cardSize.max = XMVectorSet(cardWidth, cardWidth / cardAspectRatio, 0.0f, 1.0f);
+	this->worldExtents = SolitaireGame::MakeWorldExtents();
+	this->cardSize = SolitaireGame::MakeCardSize();
 
-	this->cardsNeededClock.Reset();
+	this->inputClock.Reset();
 }
 
 /*virtual*/ Application::~Application()
@@ -220,13 +217,15 @@ bool Application::Setup(HINSTANCE instance, int cmdShow, int width, int height)
 		return false;
 	}
 
-	CD3DX12_DESCRIPTOR_RANGE1 ranges[2];
+	// All the card textures are bound at once as a single texture array, the card instances are read straight
+	// from the frame's upload buffer without any view into it, and the view matrix rides along in the root signature.
+	CD3DX12_DESCRIPTOR_RANGE1 ranges[1];
 	ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC);
-	ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_CBV, 1, 0, 0, D3D12_DESCRIPTOR_RANGE_FLAG_DATA_STATIC);
 
-	CD3DX12_ROOT_PARAMETER1 rootParameters[2];
+	CD3DX12_ROOT_PARAMETER1 rootParameters[3];
 	rootParameters[0].InitAsDescriptorTable(1, &ranges[0], D3D12_SHADER_VISIBILITY_PIXEL);
-	rootParameters[1].InitAsDescriptorTable(1, &ranges[1], D3D12_SHADER_VISIBILITY_VERTEX);
+	rootParameters[1].InitAsShaderResourceView(1, 0, D3D12_ROOT_DESCRIPTOR_FLAG_NONE, D3D12_SHADER_VISIBILITY_VERTEX);
+	rootParameters[2].InitAsConstants(sizeof(ViewConstants) / sizeof(UINT), 0, 0, D3D12_SHADER_VISIBILITY_VERTEX);
 
 	D3D12_STATIC_SAMPLER_DESC samplerDesc{};
 	samplerDesc.Filter = D3D12_FILTER_MIN_MAG_MIP_POINT;
@@ -342,65 +341,6 @@ bool Application::Setup(HINSTANCE instance, int cmdShow, int width, int height)
 
 	this->pipelineState->SetName(L"Pipeline State");
 
-	// Reserve some space in slow GPU memory for constants buffers.  Whenever the GPU
-	// wants to read the memory, it has to be marsheled over (whatever the hell that means).
-	// How else am I supposed to do this?  Is there a better way?
-	// Note that the CPU will never write into a part of this region of memory that the
-	// GPU is reading from, but I still wonder if this could be a point of slowness.
-	UINT constantsBufferSize = sizeof(CardConstantsBuffer) * this->maxCardDrawCallsPerSwapFrame * this->swapFrameArray.size();
-	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
-	auto constantsBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(constantsBufferSize);
-	result = this->device->CreateCommittedResource(
-		&heapProps,
-		D3D12_HEAP_FLAG_NONE,
-		&constantsBufferDesc,
-		D3D12_RESOURCE_STATE_GENERIC_READ,
-		nullptr,
-		IID_PPV_ARGS(&this->cardConstantsBuffer));
-	if (FAILED(result))
-	{
-		std::string error = std::format("Failed to create constants buffers.  Error code: {:x}", result);
-		MessageBox(NULL, error.c_str(), "Error!", MB_ICONERROR | MB_OK);
-		return false;
-	}
-
-	// Map the constants buffer into CPU memory.  This is so that we can update it each draw-call as necessary.
-	// Nothing wrong with just leaving it mapped for the life of the resource.
-	CD3DX12_RANGE readRange(0, 0);		// This means we never need to read from the buffer.  We only write to it.
-	result = this->cardConstantsBuffer->Map(0, &readRange, reinterpret_cast<void**>(&this->cardConstantsBufferPtr));
-	if (FAILED(result))
-	{
-		std::string error = std::format("Failed to map constants buffer.  Error code: {:x}", result);
-		MessageBox(NULL, error.c_str(), "Error!", MB_ICONERROR | MB_OK);
-		return false;
-	}
-	::ZeroMemory(this->cardConstantsBufferPtr, constantsBufferSize);
-
-	// Create a descriptor heap for constants buffers.
-	D3D12_DESCRIPTOR_HEAP_DESC cbvHeapDesc{};
-	cbvHeapDesc.NumDescriptors = this->maxCardDrawCallsPerSwapFrame * this->swapFrameArray.size();
-	cbvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	cbvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-	result = this->device->CreateDescriptorHeap(&cbvHeapDesc, IID_PPV_ARGS(&this->cbvHeap));
-	if (FAILED(result))
-	{
-		std::string error = std::format("Failed to create descriptor heap for constants buffers.  Error code: {:x}", result);
-		MessageBox(NULL, error.c_str(), "Error!", MB_ICONERROR | MB_OK);
-		return false;
-	}
-
-	// Now create a view into each constants buffer at each heap location.
-	UINT cbvDescriptorSize = this->device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	CD3DX12_CPU_DESCRIPTOR_HANDLE cbvHandle(this->cbvHeap->GetCPUDescriptorHandleForHeapStart());
-	for (UINT i = 0; i < cbvHeapDesc.NumDescriptors; i++)
-	{
-		D3D12_CONSTANT_BUFFER_VIEW_DESC cbvDesc{};
-		cbvDesc.BufferLocation = this->cardConstantsBuffer->GetGPUVirtualAddress() + i * sizeof(CardConstantsBuffer);
-		cbvDesc.SizeInBytes = sizeof(CardConstantsBuffer);
-		this->device->CreateConstantBufferView(&cbvDesc, cbvHandle);
-		cbvHandle.Offset(1, cbvDescriptorSize);
-	}
-
 	result = this->device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, this->generalCommandAllocator.Get(), this->pipelineState.Get(), IID_PPV_ARGS(&this->commandList));
 	if (FAILED(result))
 	{
@@ -421,10 +361,14 @@ bool Application::Setup(HINSTANCE instance, int cmdShow, int width, int height)
 	if (!this->LoadCardVertexBuffer())
 		return false;
 
-	std::srand(std::time(nullptr));
-
-	this->cardGame = std::make_shared<KlondikeSolitaireGame>(this->worldExtents, this->cardSize);
-	this->cardGame->NewGame();
+	// Pick up where the player left off, if we can.
+	std::filesystem::path savedGamePath;
+	if (!this->GetSavedGamePath(savedGamePath) || !this->gameController.ResumeGame(savedGamePath.string(), this->worldExtents, this->cardSize))
+	{
+		auto cardGame = std::make_shared<KlondikeSolitaireGame>(this->worldExtents, this->cardSize);
+		cardGame->NewGame();
+		this->gameController.SetGame(cardGame);
+	}
 
 	this->clock.Reset();
 
@@ -455,10 +399,10 @@ bool Application::CreateOrAdjustSwapChain(UINT width, UINT height, IDXGIFactory4
 	this->adjustedWorldExtents.ExpandToMatchAspectRatio(aspectRatio);
 	this->adjustedWorldExtents.ScaleAboutCenter(1.01f);
 	this->worldToProj = XMMatrixOrthographicOffCenterLH(
-		XMVectorGetX(this->adjustedWorldExtents.min),
-		XMVectorGetX(this->adjustedWorldExtents.max),
-		XMVectorGetY(this->adjustedWorldExtents.min),
-		XMVectorGetY(this->adjustedWorldExtents.max),
+		this->adjustedWorldExtents.min.x,
+		this->adjustedWorldExtents.max.x,
+		this->adjustedWorldExtents.min.y,
+		this->adjustedWorldExtents.max.y,
 		0.0f,
 		1.0f
 	);
@@ -667,35 +611,97 @@ bool Application::LoadCardVertexBuffer()
 
 bool Application::LoadCardTextures()
 {
-	// Locate our texture asset directory.
+	// The slices have to be in the order the cards number their textures, so that each card can be drawn
+	// from the slice of its texture index without looking anything up.
+	std::vector<std::string> renderKeyArray;
+	SolitaireGame::Card::GetAllRenderKeys(renderKeyArray);
+
+	// The textures are normally packed ahead of time into a single file by solitaire-pack-textures,
+	// but if that hasn't been done, or it was done for some other set of cards, we can just as well
+	// pack them ourselves from the individual files.
+	TextureArray textureArray;
 	std::filesystem::path folderPath;
-	if (!this->FindAssetDirectory("Textures", folderPath))
+	bool packed = this->FindAssetDirectory(PACKED_TEXTURE_FOLDER_NAME, folderPath) && textureArray.LoadFile((folderPath / PACKED_CARD_TEXTURE_FILE_NAME).string());
+	for (int i = 0; packed && i < int(renderKeyArray.size()); i++)
+		packed = i < textureArray.GetSliceCount() && textureArray.GetSliceName(i) == renderKeyArray[i];
+
+	if (!packed)
+	{
+		if (!this->FindAssetDirectory("Textures", folderPath))
+		{
+			MessageBox(NULL, "Failed to locate textures directory.", "Error!", MB_ICONERROR | MB_OK);
+			return false;
+		}
+
+		textureArray.Clear();
+		std::string failedFilePath;
+		if (!textureArray.AddSlicesFromFolder(folderPath.string(), renderKeyArray, failedFilePath))
+		{
+			std::string error = std::format("Failed to load texture \"{}\".", failedFilePath);
+			MessageBox(NULL, error.c_str(), "Error!", MB_ICONERROR | MB_OK);
+			return false;
+		}
+	}
+
+	// Reserve GPU memory that has fast-access from a pixel shader for all the textures, each one a slice of the array.
+	auto textureDesc = CD3DX12_RESOURCE_DESC::Tex2D(DXGI_FORMAT_R8G8B8A8_UNORM, textureArray.GetWidth(), textureArray.GetHeight(),
+		UINT16(textureArray.GetSliceCount()), UINT16(textureArray.GetMipCount()));
+	CD3DX12_HEAP_PROPERTIES textureHeapProps(D3D12_HEAP_TYPE_DEFAULT);
+	HRESULT result = this->device->CreateCommittedResource(
+		&textureHeapProps,
+		D3D12_HEAP_FLAG_NONE,
+		&textureDesc,
+		D3D12_RESOURCE_STATE_COPY_DEST,
+		nullptr,
+		IID_PPV_ARGS(&this->cardTextureArray));
+	if (FAILED(result))
 	{
-		MessageBox(NULL, "Failed to locate textures directory.", "Error!", MB_ICONERROR | MB_OK);
+		std::string error = std::format("Failed to create card texture array.  Error code: {:x}", result);
+		MessageBox(NULL, error.c_str(), "Error!", MB_ICONERROR | MB_OK);
 		return false;
 	}
 
-	// Soak up all the texture file names we find in the asset folder.
-	std::vector<std::string> textureFileArray;
-	for (const auto& entry : std::filesystem::directory_iterator(folderPath))
+	this->cardTextureArray->SetName(L"Card Texture Array");
+
+	// Subresources are numbered by mip within slice, which is also how the texture array lays out its pixels.
+	std::vector<D3D12_SUBRESOURCE_DATA> subresources;
+	for (int slice = 0; slice < textureArray.GetSliceCount(); slice++)
 	{
-		std::string ext = entry.path().extension().string();
-		if (ext == ".dds")
-			textureFileArray.push_back(entry.path().string());
+		for (UINT32 mip = 0; mip < textureArray.GetMipCount(); mip++)
+		{
+			D3D12_SUBRESOURCE_DATA subresource{};
+			subresource.pData = textureArray.GetPixels(slice, mip);
+			subresource.RowPitch = LONG_PTR(textureArray.GetMipWidth(mip)) * 4;
+			subresource.SlicePitch = subresource.RowPitch * textureArray.GetMipHeight(mip);
+			subresources.push_back(subresource);
+		}
 	}
 
-	if (textureFileArray.size() == 0)
+	// This will reserve GPU memory that has slow-access from a pixel shader (I think!), but can also be mapped into CPU memory.
+	UINT64 uploadBufferSize = GetRequiredIntermediateSize(this->cardTextureArray.Get(), 0, (UINT)subresources.size());
+	auto intermediateTextureDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
+	ComPtr<ID3D12Resource> intermediateTexture;
+	CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+	result = this->device->CreateCommittedResource(
+		&heapProps,
+		D3D12_HEAP_FLAG_NONE,
+		&intermediateTextureDesc,
+		D3D12_RESOURCE_STATE_GENERIC_READ,
+		nullptr,
+		IID_PPV_ARGS(&intermediateTexture));
+	if (FAILED(result))
 	{
-		MessageBox(NULL, "No textures found!", "Error!", MB_ICONERROR | MB_OK);
+		std::string error = std::format("Failed to create intermediate resource for card texture array.  Error code: {:x}", result);
+		MessageBox(NULL, error.c_str(), "Error!", MB_ICONERROR | MB_OK);
 		return false;
 	}
 
-	// We'll need a heap of SRVs for all the textures.
+	// We'll need a heap with an SRV for the texture array.  It's the only one, so nothing ever switches between them.
 	D3D12_DESCRIPTOR_HEAP_DESC srvHeapDesc{};
-	srvHeapDesc.NumDescriptors = (UINT)textureFileArray.size();
+	srvHeapDesc.NumDescriptors = 1;
 	srvHeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
 	srvHeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-	HRESULT result = this->device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&this->srvHeap));
+	result = this->device->CreateDescriptorHeap(&srvHeapDesc, IID_PPV_ARGS(&this->srvHeap));
 	if (FAILED(result))
 	{
 		std::string error = std::format("Failed to create SRV heap.  Error code: {:x}", result);
@@ -703,10 +709,13 @@ bool Application::LoadCardTextures()
 		return false;
 	}
 
-	// Get ready to walk the heap.
-	UINT srvDescriptorSize = this->device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	CD3DX12_CPU_DESCRIPTOR_HANDLE srvHandle(this->srvHeap->GetCPUDescriptorHandleForHeapStart());
-	UINT srvOffset = 0;
+	D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
+	srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+	srvDesc.Format = textureDesc.Format;
+	srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+	srvDesc.Texture2DArray.MipLevels = textureArray.GetMipCount();
+	srvDesc.Texture2DArray.ArraySize = UINT(textureArray.GetSliceCount());
+	this->device->CreateShaderResourceView(this->cardTextureArray.Get(), &srvDesc, this->srvHeap->GetCPUDescriptorHandleForHeapStart());
 
 	// Get ready to generate a new command list.  This will open the command list for recording.
 	result = this->generalCommandAllocator->Reset();
@@ -724,79 +733,16 @@ bool Application::LoadCardTextures()
 		return false;
 	}
 
-	// We'll need these to stay in scope until the GPU is done with them.
-	std::vector<ComPtr<ID3D12Resource>> intermediateTextureArray;
+	// This will map the intermediate texture into CPU memory, copy the texture data into it (into GPU memory),
+	// then record a command that will transfer the texture data from slow GPU memory to fast GPU memory.
+	UpdateSubresources(this->commandList.Get(), this->cardTextureArray.Get(), intermediateTexture.Get(), 0, 0, (UINT)subresources.size(), subresources.data());
 
-	// Now go load up all the textures we found.
-	for(const std::string& textureFile : textureFileArray)
-	{
-		// This will load the texture data into CPU memory and then reserve GPU memory that has fast-access from a pixel shader, but that's all it does.
-		std::wstring ddsFilePath = std::wstring_convert<std::codecvt_utf8<wchar_t>>().from_bytes(textureFile);
-		std::unique_ptr<uint8_t[]> ddsData;
-		std::vector<D3D12_SUBRESOURCE_DATA> subresources;
-		ComPtr<ID3D12Resource> texture;
-		result = LoadDDSTextureFromFile(this->device.Get(), ddsFilePath.c_str(), &texture, ddsData, subresources);
-		if (FAILED(result))
-		{
-			std::string error = std::format("Failed to load texture \"{}\".  Error code: {:x}", textureFile.c_str(), result);
-			MessageBox(NULL, error.c_str(), "Error!", MB_ICONERROR | MB_OK);
-			return false;
-		}
-
-		// This will reserve GPU memory that has slow-access from a pixel shader (I think!), but can also be mapped into CPU memory.
-		UINT64 uploadBufferSize = GetRequiredIntermediateSize(texture.Get(), 0, (UINT)subresources.size());
-		auto intermediateTextureDesc = CD3DX12_RESOURCE_DESC::Buffer(uploadBufferSize);
-		ComPtr<ID3D12Resource> intermediateTexture;
-		CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
-		result = this->device->CreateCommittedResource(
-			&heapProps,
-			D3D12_HEAP_FLAG_NONE,
-			&intermediateTextureDesc,
-			D3D12_RESOURCE_STATE_GENERIC_READ,
-			nullptr,
-			IID_PPV_ARGS(&intermediateTexture));
-		if (FAILED(result))
-		{
-			std::string error = std::format("Failed to create resource for texture with high GPU availability.  Error code: {:x}", result);
-			MessageBox(NULL, error.c_str(), "Error!", MB_ICONERROR | MB_OK);
-			return false;
-		}
-
-		// Keep the intermediate texture in scope until the GPU is done with it.
-		intermediateTextureArray.push_back(intermediateTexture);
-
-		// This will map the intermediate texture into CPU memory, copy the loaded texture data into it (into GPU memory),
-		// then record a command that will transfer the texture data from slow GPU memory to fast GPU memory.
-		UpdateSubresources(this->commandList.Get(), texture.Get(), intermediateTexture.Get(), 0, 0, (UINT)subresources.size(), subresources.data());
-
-		// Now record a command that will change the resource state of the fast GPU memory texture from that of a copy destination to a pixel shader data source.
-		auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(texture.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
-		this->commandList->ResourceBarrier(1, &barrier);
-
-		// We'll need a shader resource view into the texture for later rendering.
-		D3D12_RESOURCE_DESC textureDesc = texture->GetDesc();
-		D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc{};
-		srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
-		srvDesc.Format = textureDesc.Format;
-		srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
-		srvDesc.Texture2D.MipLevels = 1;
-		this->device->CreateShaderResourceView(texture.Get(), &srvDesc, srvHandle);
-
-		// Move the shader resource view handle along to the next one in the heap.
-		srvHandle.Offset(1, srvDescriptorSize);
-
-		// Lastly, save the CPU-side reference we have to the texture in our map so that we can use it later for rendering.
-		CardTexture cardTexture{ texture, srvOffset++ };
-		std::string cardName = std::filesystem::path(textureFile).stem().string();
-		this->cardTextureMap.insert(std::pair(cardName, cardTexture));
-
-		// I don't think we need to keep the intermediate texture around, so might as well discard it.
-		D3D12_DISCARD_REGION region{};
-		region.NumSubresources = 1;
-		this->commandList->DiscardResource(intermediateTexture.Get(), &region);
-	}
+	// Now record a command that will change the resource state of the fast GPU memory texture from that of a copy destination to a pixel shader data source.
+	auto barrier = CD3DX12_RESOURCE_BARRIER::Transition(this->cardTextureArray.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE);
+	this->commandList->ResourceBarrier(1, &barrier);
 
 	// Now go tell the GPU to transfer the textures from slow GPU memory to fast GPU memory.  Stall until the operation is complete.
+	// The intermediate texture has to stay in scope until then.
 	this->commandList->Close();
 	this->ExecuteCommandList();
 	this->WaitForGPUIdle();
@@ -811,14 +757,19 @@ void Application::Shutdown(HINSTANCE instance)
 	// to wait for the GPU to finish before any resources are released
 	// either here or when the destructors are called.
 	this->WaitForGPUIdle();
-	
-	this->cardGame.reset();
+
+	std::filesystem::path savedGamePath;
+	if (this->GetSavedGamePath(savedGamePath))
+		this->gameController.SaveGame(savedGamePath.string());
+
+	this->gameController.Clear();
 
 	for (SwapFrame& frame : this->swapFrameArray)
 	{
 		frame.renderTarget = nullptr;
 		frame.commandAllocator = nullptr;
 		frame.fence = nullptr;
+		frame.uploadPageArray.clear();
 
 		if (frame.fenceEvent != NULL)
 		{
@@ -840,12 +791,10 @@ void Application::Shutdown(HINSTANCE instance)
 	// been reserved on the GPU.  I suppose we could go issue commands to discard
 	// all resources we reserved/committed, but maybe that's just completely unecessary.
 	// Maybe the D3D12 driver takes care of having the GPU free all its memory that we used?
-	this->cbvHeap = nullptr;
-	this->cardConstantsBuffer = nullptr;
 	this->cardVertexBuffer = nullptr;
 	this->generalFence = nullptr;
 	this->generalCommandAllocator = nullptr;
-	this->cardTextureMap.clear();
+	this->cardTextureArray = nullptr;
 	this->swapChain = nullptr;
 	this->commandQueue = nullptr;
 	this->rtvHeap = nullptr;
@@ -890,6 +839,23 @@ bool Application::FindAssetDirectory(const std::string& folderName, std::filesys
 	return false;
 }
 
+bool Application::GetSavedGamePath(std::filesystem::path& filePath)
+{
+	char localAppDataPath[MAX_PATH];
+	DWORD pathLength = GetEnvironmentVariableA("LOCALAPPDATA", localAppDataPath, sizeof(localAppDataPath));
+	if (pathLength == 0 || pathLength >= sizeof(localAppDataPath))
+		return false;
+
+	std::filesystem::path folderPath = std::filesystem::path(localAppDataPath) / SAVED_GAME_FOLDER_NAME;
+	std::error_code error;
+	std::filesystem::create_directories(folderPath, error);
+	if (error)
+		return false;
+
+	filePath = folderPath / SAVED_GAME_FILE_NAME;
+	return true;
+}
+
 int Application::Run()
 {
 	MSG msg{};
@@ -910,35 +876,46 @@ int Application::Run()
 
 void Application::Tick()
 {
-	this->tickCount++;
+	// A frame runs from here to the end of Render().
+	this->frameAllocationReport.BeginFrame();
 
 	double deltaTimeSeconds = this->clock.GetCurrentTimeSeconds(true);
 
-	this->tickTimeList.push_back(deltaTimeSeconds);
-	while (this->tickTimeList.size() > TICKS_PER_FPS_PROFILE)
-		this->tickTimeList.pop_front();
+	// Nothing in here should touch the heap, so the tick times go round a fixed ring and
+	// the report is printed into a buffer on the stack.
+	this->tickTimeArray[this->tickCount % TICKS_PER_FPS_PROFILE] = deltaTimeSeconds;
+	this->tickCount++;
 
 	if (this->tickCount % TICKS_PER_FPS_PROFILE == 0)
 	{
 		double averageSecondsPerTick = 0.0;
-		for (double secondsPerTick : this->tickTimeList)
-			averageSecondsPerTick += secondsPerTick;
-		averageSecondsPerTick /= double(this->tickTimeList.size());
+		for (int i = 0; i < TICKS_PER_FPS_PROFILE; i++)
+			averageSecondsPerTick += this->tickTimeArray[i];
+		averageSecondsPerTick /= double(TICKS_PER_FPS_PROFILE);
 		double averageFPS = 1.0 / averageSecondsPerTick;
-		OutputDebugStringA(std::format("Average FPS: {}\n", averageFPS).c_str());
+
+		char message[256];
+		if (AllocationTracker::IsCounting())
+		{
+			::snprintf(message, sizeof(message), "Average FPS: %f, allocations per frame: %.2f average, %llu max\n", averageFPS,
+				this->frameAllocationReport.GetAverageFrameAllocationCount(), (unsigned long long)this->frameAllocationReport.GetMaxFrameAllocationCount());
+			this->frameAllocationReport.Reset();
+		}
+		else
+			::snprintf(message, sizeof(message), "Average FPS: %f\n", averageFPS);
+		OutputDebugStringA(message);
 	}
 
-	if (this->cardGame)
+	SolitaireGame* cardGame = this->gameController.GetGame();
+	if (cardGame)
 	{
-		if (this->cardGame->GameWon())
+		if (cardGame->GameWon())
 		{
 			MessageBoxA(this->windowHandle, "You won!", "Yay!", MB_ICONINFORMATION | MB_OK);
-			this->cardGame->NewGame();
-			this->gameFutureList.clear();
-			this->gameHistoryList.clear();
+			this->gameController.NewGame();
 		}
 
-		this->cardGame->Tick(deltaTimeSeconds);
+		this->gameController.Tick(deltaTimeSeconds);
 	}
 }
 
@@ -956,6 +933,10 @@ void Application::Render()
 	// Note that we would not want to do this if the GPU was still using the commands.
 	result = frame.commandAllocator->Reset();
 	assert(SUCCEEDED(result));
+
+	// The same goes for the frame's upload buffers.  If they were outgrown last time around, they're replaced by one big enough.
+	if (frame.uploadAllocator.Reset())
+		frame.uploadPageArray.clear();
 	
 	// Have our command list take memory for commands from the frame's command allocator.
 	// This also opens the command list for recording.
@@ -981,18 +962,12 @@ void Application::Render()
 	this->commandList->RSSetScissorRects(1, &this->scissorRect);
 
 	// Rendering our scene boils down to nothing more than just drawing a bunch of cards.
-	if (this->cardGame.get())
+	if (this->gameController.GetGame())
 	{
-		UINT drawCallCount = 0;
-		std::vector<const SolitaireGame::Card*> cardRenderList;
-		this->cardGame->GenerateRenderList(cardRenderList);
-		for (auto card : cardRenderList)
-		{
-			if (drawCallCount >= this->maxCardDrawCallsPerSwapFrame)
-				break;
-
-			this->RenderCard(card, drawCallCount++);
-		}
+		// The render list keeps its capacity from frame to frame.
+		this->renderList.clear();
+		this->gameController.GetGame()->GenerateRenderList(this->renderList);
+		this->RenderCards(this->renderList, frame);
 	}
 
 	// Indicate that the back-buffer can now be used to present.
@@ -1019,6 +994,8 @@ void Application::Render()
 
 	// Now schedual a fence event to occur once the command list finishes.
 	this->commandQueue->Signal(frame.fence.Get(), ++frame.count);
+
+	this->frameAllocationReport.EndFrame();
 }
 
 void Application::ExecuteCommandList()
@@ -1059,48 +1036,92 @@ void Application::WaitForGPUIdle()
 	}
 }
 
-void Application::RenderCard(const SolitaireGame::Card* card, UINT drawCallCount)
+bool Application::AllocateUploadSpace(SwapFrame& frame, UINT64 size, UINT64 alignment, UINT8*& bufferPtr, D3D12_GPU_VIRTUAL_ADDRESS& gpuAddress)
+{
+	LinearAllocator::Allocation allocation = frame.uploadAllocator.Allocate(size, alignment);
+
+	// Pages are only ever added at the end, and memory is only made for them the first time they're used.
+	while (int(frame.uploadPageArray.size()) <= allocation.page)
+	{
+		int page = int(frame.uploadPageArray.size());
+		UploadPage uploadPage{};
+		CD3DX12_HEAP_PROPERTIES heapProps(D3D12_HEAP_TYPE_UPLOAD);
+		auto bufferDesc = CD3DX12_RESOURCE_DESC::Buffer(frame.uploadAllocator.GetPageSize(page));
+		HRESULT result = this->device->CreateCommittedResource(
+			&heapProps,
+			D3D12_HEAP_FLAG_NONE,
+			&bufferDesc,
+			D3D12_RESOURCE_STATE_GENERIC_READ,
+			nullptr,
+			IID_PPV_ARGS(&uploadPage.buffer));
+		if (FAILED(result))
+			return false;
+
+		// Nothing wrong with just leaving it mapped for the life of the resource.
+		CD3DX12_RANGE readRange(0, 0);		// This means we never need to read from the buffer.  We only write to it.
+		result = uploadPage.buffer->Map(0, &readRange, reinterpret_cast<void**>(&uploadPage.bufferPtr));
+		if (FAILED(result))
+			return false;
+
+		uploadPage.buffer->SetName(L"Upload Page");
+		frame.uploadPageArray.push_back(uploadPage);
+	}
+
+	const UploadPage& uploadPage = frame.uploadPageArray[allocation.page];
+	bufferPtr = uploadPage.bufferPtr + allocation.offset;
+	gpuAddress = uploadPage.buffer->GetGPUVirtualAddress() + allocation.offset;
+	return true;
+}
+
+void Application::RenderCards(const std::vector<SolitaireGame::RenderItem>& renderList, SwapFrame& frame)
 {
 	// Note that here we're assuming that the command list is in the record state,
 	// ready for us to record rendering commands.
 
-	std::string renderKey = card->GetRenderKey();
-	auto pair = this->cardTextureMap.find(renderKey);
-	if (pair == this->cardTextureMap.end())
+	this->renderCommandList.Reset();
+	this->renderCommandList.RecordCards(renderList, this->cardSize);
+
+	// Write every card for the frame into the frame's upload buffer in one go.
+	const std::vector<RenderCommandList::CardInstance>& instanceArray = this->renderCommandList.GetInstanceArray();
+	if (instanceArray.size() == 0)
 		return;
 
-	XMMATRIX scaleMatrix = XMMatrixScaling(this->cardSize.GetWidth(), this->cardSize.GetHeight(), 1.0f);
-	XMMATRIX translationMatrix = XMMatrixTranslation(XMVectorGetX(card->position), XMVectorGetY(card->position), 0.0f);
-	XMMATRIX objToWorld = scaleMatrix * translationMatrix;
+	UINT64 instanceBufferSize = instanceArray.size() * sizeof(RenderCommandList::CardInstance);
+	UINT8* bufferPtr = nullptr;
+	D3D12_GPU_VIRTUAL_ADDRESS instanceBufferAddress = 0;
+	if (!this->AllocateUploadSpace(frame, instanceBufferSize, sizeof(RenderCommandList::CardInstance), bufferPtr, instanceBufferAddress))
+		return;
 
-	const CardTexture& cardTexture = pair->second;
+	::memcpy(bufferPtr, instanceArray.data(), instanceBufferSize);
 
-	// Fill out our constants buffer for this draw call.
-	UINT i = this->swapChain->GetCurrentBackBufferIndex();
-	UINT j = i * this->maxCardDrawCallsPerSwapFrame + drawCallCount;
-	auto cardConstantsBufferData = &reinterpret_cast<CardConstantsBuffer*>(this->cardConstantsBufferPtr)[j];
-	cardConstantsBufferData->objToProj = objToWorld * this->worldToProj;
-
-	// Use the desired texture.
-	ID3D12DescriptorHeap* descriptorHeapArray[] = { this->srvHeap.Get() };		// Note that all of these must be the same type of heap.
+	// Everything the cards need is bound just the once.
+	ID3D12DescriptorHeap* descriptorHeapArray[] = { this->srvHeap.Get() };
 	this->commandList->SetDescriptorHeaps(_countof(descriptorHeapArray), descriptorHeapArray);
-	UINT srvDescriptorSize = this->device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	CD3DX12_GPU_DESCRIPTOR_HANDLE srvHandle(this->srvHeap->GetGPUDescriptorHandleForHeapStart(), cardTexture.srvOffset, srvDescriptorSize);
-	this->commandList->SetGraphicsRootDescriptorTable(0, srvHandle);
+	this->commandList->SetGraphicsRootDescriptorTable(0, this->srvHeap->GetGPUDescriptorHandleForHeapStart());
+	this->commandList->SetGraphicsRootShaderResourceView(1, instanceBufferAddress);
 
-	// Make sure our constants buffer is bound.
-	descriptorHeapArray[0] = { this->cbvHeap.Get() };
-	this->commandList->SetDescriptorHeaps(_countof(descriptorHeapArray), descriptorHeapArray);
-	UINT cbvDescriptorSize = this->device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
-	CD3DX12_GPU_DESCRIPTOR_HANDLE cbvHandle(this->cbvHeap->GetGPUDescriptorHandleForHeapStart(), j, cbvDescriptorSize);
-	this->commandList->SetGraphicsRootDescriptorTable(1, cbvHandle);
+	ViewConstants viewConstants{};
+	XMStoreFloat4x4(&viewConstants.worldToProj, this->worldToProj);
 
-	// TODO: We might not need to call these for each card.  Maybe just once before drawing all cards.
 	this->commandList->IASetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
 	this->commandList->IASetVertexBuffers(0, 1, &this->cardVertexBufferView);
 
-	// Finally, make the draw call!
-	this->commandList->DrawInstanced(6, 1, 0, 0);
+	// Now play back what was recorded.
+	for (const RenderCommandList::Command& command : this->renderCommandList.GetCommandArray())
+	{
+		switch (command.type)
+		{
+		case RenderCommandList::Command::Type::DRAW_INSTANCED:
+		{
+			viewConstants.firstInstance = command.firstInstance;
+			this->commandList->SetGraphicsRoot32BitConstants(2, sizeof(ViewConstants) / sizeof(UINT), &viewConstants, 0);
+			this->commandList->DrawInstanced(command.vertexCount, command.instanceCount, 0, 0);
+			break;
+		}
+		default:
+			break;
+		}
+	}
 }
 
 /*static*/ LRESULT CALLBACK Application::WindowProc(HWND windowHandle, UINT message, WPARAM wParam, LPARAM lParam)
@@ -1206,9 +1227,7 @@ void Application::RenderCard(const SolitaireGame::Card* card, UINT drawCallCount
 				}
 				case ID_NEW_GAME:
 				{
-					app->cardGame->NewGame();
-					app->gameFutureList.clear();
-					app->gameHistoryList.clear();
+					app->gameController.NewGame();
 					break;
 				}
 				case ID_ABOUT:
@@ -1220,53 +1239,46 @@ void Application::RenderCard(const SolitaireGame::Card* card, UINT drawCallCount
 				}
 				case ID_SPIDER:
 				{
-					if (!dynamic_cast<SpiderSolitaireGame*>(app->cardGame.get()))
+					if (!dynamic_cast<SpiderSolitaireGame*>(app->gameController.GetGame()))
 					{
 						auto difficultyLevel = SpiderSolitaireGame::DifficultyLevel::LOW;	// TODO: Ask user for the difficulty level?
-						app->cardGame = std::make_shared<SpiderSolitaireGame>(app->worldExtents, app->cardSize, difficultyLevel);
-						app->cardGame->NewGame();
+						auto cardGame = std::make_shared<SpiderSolitaireGame>(app->worldExtents, app->cardSize, difficultyLevel);
+						cardGame->NewGame();
+						app->gameController.SetGame(cardGame);
 					}
 
 					break;
 				}
 				case ID_KLONDIKE:
 				{
-					if (!dynamic_cast<KlondikeSolitaireGame*>(app->cardGame.get()))
+					if (!dynamic_cast<KlondikeSolitaireGame*>(app->gameController.GetGame()))
 					{
-						app->cardGame = std::make_shared<KlondikeSolitaireGame>(app->worldExtents, app->cardSize);
-						app->cardGame->NewGame();
+						auto cardGame = std::make_shared<KlondikeSolitaireGame>(app->worldExtents, app->cardSize);
+						cardGame->NewGame();
+						app->gameController.SetGame(cardGame);
 					}
 
 					break;
 				}
 				case ID_FREECELL:
 				{
-					if (!dynamic_cast<FreeCellSolitaireGame*>(app->cardGame.get()))
+					if (!dynamic_cast<FreeCellSolitaireGame*>(app->gameController.GetGame()))
 					{
-						app->cardGame = std::make_shared<FreeCellSolitaireGame>(app->worldExtents, app->cardSize);
-						app->cardGame->NewGame();
+						auto cardGame = std::make_shared<FreeCellSolitaireGame>(app->worldExtents, app->cardSize);
+						cardGame->NewGame();
+						app->gameController.SetGame(cardGame);
 					}
 
 					break;
 				}
 				case ID_UNDO:
 				{
-					if (app->gameHistoryList.size() > 0)
-					{
-						app->gameFutureList.push_front(app->cardGame);
-						app->cardGame = app->gameHistoryList.back();
-						app->gameHistoryList.pop_back();
-					}
+					app->gameController.Undo();
 					break;
 				}
 				case ID_REDO:
 				{
-					if (app->gameFutureList.size() > 0)
-					{
-						app->gameHistoryList.push_back(app->cardGame);
-						app->cardGame = *app->gameFutureList.begin();
-						app->gameFutureList.pop_front();
-					}
+					app->gameController.Redo();
 					break;
 				}
 			}
@@ -1288,7 +1300,7 @@ void Application::RenderCard(const SolitaireGame::Card* card, UINT drawCallCount
 					{
 						case ID_SPIDER:
 						{
-							if (dynamic_cast<SpiderSolitaireGame*>(app->cardGame.get()))
+							if (dynamic_cast<SpiderSolitaireGame*>(app->gameController.GetGame()))
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_CHECKED, ID_SPIDER, "Spider");
 							else
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_UNCHECKED, ID_SPIDER, "Spider");
@@ -1296,7 +1308,7 @@ void Application::RenderCard(const SolitaireGame::Card* card, UINT drawCallCount
 						}
 						case ID_KLONDIKE:
 						{
-							if (dynamic_cast<KlondikeSolitaireGame*>(app->cardGame.get()))
+							if (dynamic_cast<KlondikeSolitaireGame*>(app->gameController.GetGame()))
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_CHECKED, ID_KLONDIKE, "Klondike");
 							else
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_UNCHECKED, ID_KLONDIKE, "Klondike");
@@ -1304,7 +1316,7 @@ void Application::RenderCard(const SolitaireGame::Card* card, UINT drawCallCount
 						}
 						case ID_FREECELL:
 						{
-							if (dynamic_cast<FreeCellSolitaireGame*>(app->cardGame.get()))
+							if (dynamic_cast<FreeCellSolitaireGame*>(app->gameController.GetGame()))
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_CHECKED, ID_FREECELL, "Free Cell");
 							else
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_UNCHECKED, ID_FREECELL, "Free Cell");
@@ -1312,7 +1324,7 @@ void Application::RenderCard(const SolitaireGame::Card* card, UINT drawCallCount
 						}
 						case ID_UNDO:
 						{
-							if(app->gameHistoryList.size() > 0)
+							if (app->gameController.GetHistory().CanUndo())
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_ENABLED, ID_UNDO, "Undo");
 							else
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_DISABLED, ID_UNDO, "Undo");
@@ -1320,7 +1332,7 @@ void Application::RenderCard(const SolitaireGame::Card* card, UINT drawCallCount
 						}
 						case ID_REDO:
 						{
-							if (app->gameFutureList.size() > 0)
+							if (app->gameController.GetHistory().CanRedo())
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_ENABLED, ID_REDO, "Redo");
 							else
 								ModifyMenu(menu, i, MF_BYPOSITION | MF_DISABLED, ID_REDO, "Redo");
@@ -1345,117 +1357,71 @@ void Application::OnWindowResized(int width, int height)
 
 void Application::OnLeftMouseButtonDown(WPARAM wParam, LPARAM lParam)
 {
-	XMVECTOR worldMousePoint = this->MouseLocationToWorldLocation(lParam);
+	Vector2D worldMousePoint = this->MouseLocationToWorldLocation(lParam);
 
-	if (this->cardGame.get())
+	if (this->gameController.OnMouseGrab(worldMousePoint))
 	{
-		this->cardGameClone = this->cardGame->Clone();
-
-		if (this->cardGame->OnMouseGrabAt(worldMousePoint))
-		{
-			SetCapture(this->windowHandle);
-			this->mouseCaptured = true;
-		}
+		SetCapture(this->windowHandle);
+		this->mouseCaptured = true;
 	}
 }
 
 void Application::OnLeftMouseButtonUp(WPARAM wParam, LPARAM lParam)
 {
-	XMVECTOR worldMousePoint = this->MouseLocationToWorldLocation(lParam);
+	Vector2D worldMousePoint = this->MouseLocationToWorldLocation(lParam);
 
-	if (this->cardGame.get())
-	{
-		if (this->cardGame->OnMouseReleaseAt(worldMousePoint))
-		{
-			assert(this->cardGameClone.get() != nullptr);
-			this->gameFutureList.clear();
-			this->gameHistoryList.push_back(this->cardGameClone);
-		}
-	}
+	this->gameController.OnMouseRelease(worldMousePoint);
 
 	if (this->mouseCaptured)
 	{
 		ReleaseCapture();
 		this->mouseCaptured = false;
 	}
-
-	this->cardGameClone = nullptr;
 }
 
 void Application::OnMouseCaptureChanged(WPARAM wParam, LPARAM lParam)
 {
 	if (this->mouseCaptured && GetCapture() != this->windowHandle)
 	{
-		if (this->cardGame.get())
-			this->cardGame->OnMouseReleaseAt(this->worldExtents.max);
+		this->gameController.OnMouseRelease(this->worldExtents.max);
 
 		this->mouseCaptured = false;
-		this->cardGameClone = nullptr;
 	}
 }
 
 void Application::OnMouseMove(WPARAM wParam, LPARAM lParam)
 {
-	XMVECTOR worldMousePoint = this->MouseLocationToWorldLocation(lParam);
+	Vector2D worldMousePoint = this->MouseLocationToWorldLocation(lParam);
 
-	if (this->cardGame.get())
-		this->cardGame->OnMouseMove(worldMousePoint);
+	this->gameController.OnMouseMove(worldMousePoint);
 }
 
 void Application::OnKeyUp(WPARAM wParam, LPARAM lParam)
 {
-	if (this->cardGame.get())
-		this->cardGame->OnKeyUp(wParam);
+	this->gameController.OnKeyUp(uint32_t(wParam));
 }
 
 void Application::OnRightMouseButtonUp(WPARAM wParam, LPARAM lParam)
 {
-	if (this->cardGame.get())
-	{
-		// A clock is used here to prevent getting more cards faster
-		// than the user really wants them.  For example, my mouse button
-		// has a problem where I'll click it once, but I'll get multiple
-		// events firing here, because there the mouse hardware is malfunctioning.
-		// This also prevents problems with an accidental double-clicking of the mouse button.
-		if (this->cardsNeededClock.GetCurrentTimeSeconds() > MIN_TIME_BETWEEN_CARDS_NEEDED)
-		{
-			this->cardGameClone = this->cardGame->Clone();
-
-			if (this->cardGame->OnCardsNeeded())
-			{
-				this->gameFutureList.clear();
-				this->gameHistoryList.push_back(this->cardGameClone);
-			}
-
-			this->cardsNeededClock.Reset();
-		}
-	}
+	// A clock is used here to prevent getting more cards faster
+	// than the user really wants them.  For example, my mouse button
+	// has a problem where I'll click it once, but I'll get multiple
+	// events firing here, because there the mouse hardware is malfunctioning.
+	// This also prevents problems with an accidental double-clicking of the mouse button.
+	this->gameController.OnCardsNeeded(this->inputClock.GetCurrentTimeSeconds());
 }
 
-XMVECTOR Application::MouseLocationToWorldLocation(LPARAM lParam)
+Vector2D Application::MouseLocationToWorldLocation(LPARAM lParam)
 {
 	int mouseX = GET_X_LPARAM(lParam);
 	int mouseY = this->viewport.Height - GET_Y_LPARAM(lParam);
-	XMVECTOR mousePoint = XMVectorSet(
-		float(mouseX),
-		float(mouseY),
-		0.0f,
-		1.0f
-	);
+	Vector2D mousePoint(float(mouseX), float(mouseY));
 
 	Box viewportBox;
-	viewportBox.min = XMVectorSet(
-		0.0f,
-		0.0f,
-		0.0f,
-		1.0f);
-	viewportBox.max = XMVectorSet(
-		float(this->viewport.Width),
-		float(this->viewport.Height),
-		0.0f,
-		1.0f);
+	viewportBox.min = Vector2D(0.0f, 0.0f);
+	viewportBox.max = Vector2D(float(this->viewport.Width), float(this->viewport.Height));
 
-	XMVECTOR uvs = viewportBox.PointToUVs(mousePoint);
-	XMVECTOR worldMousePoint = this->adjustedWorldExtents.PointFromUVs(uvs);
+	Vector2D uvs = viewportBox.PointToUVs(mousePoint);
+	Vector2D worldMousePoint = this->adjustedWorldExtents.PointFromUVs(uvs);
 	return worldMousePoint;
 }
\ No newline at end of file
@@ -8,19 +8,26 @@
 #include <d3dcompiler.h>
 #include <wrl.h>
 #include <filesystem>
-#include <unordered_map>
-#include <DDSTextureLoader.h>
 #include <DirectXMath.h>
 #include "Clock.h"
 #include "SolitaireGame.h"
+#include "GameController.h"
 #include "Box.h"
+#include "RenderCommandList.h"
+#include "LinearAllocator.h"
+#include "TextureArray.h"
+#include "AllocationTracker.h"
 
 using Microsoft::WRL::ComPtr;
 
 #define WINDOW_CLASS_NAME				"SolitaireWindow"
 #define NUM_SWAP_CHAIN_FRAMES			2
 #define TICKS_PER_FPS_PROFILE			32
-#define MIN_TIME_BETWEEN_CARDS_NEEDED	0.5
+#define SAVED_GAME_FOLDER_NAME			"Solitaire"
+#define SAVED_GAME_FILE_NAME			"SavedGame.bin"
+#define UPLOAD_PAGE_SIZE				65536
+#define PACKED_TEXTURE_FOLDER_NAME		"PackedTextures"
+#define PACKED_CARD_TEXTURE_FILE_NAME	"CardTextures.dds"
 
 enum
 {
@@ -54,12 +61,14 @@ private:
 	void WaitForGPUIdle();
 	void StallUntilFrameCompleteIfNecessary(SwapFrame& frame);
 	bool FindAssetDirectory(const std::string& folderName, std::filesystem::path& folderPath);
+	bool GetSavedGamePath(std::filesystem::path& filePath);
 	std::string GetErrorMessageFromBlob(ID3DBlob* errorBlob);
 	bool LoadCardTextures();
 	bool LoadCardVertexBuffer();
 	void ExecuteCommandList();
-	void RenderCard(const SolitaireGame::Card* card, UINT drawCallCount);
-	DirectX::XMVECTOR MouseLocationToWorldLocation(LPARAM lParam);
+	bool AllocateUploadSpace(SwapFrame& frame, UINT64 size, UINT64 alignment, UINT8*& bufferPtr, D3D12_GPU_VIRTUAL_ADDRESS& gpuAddress);
+	void RenderCards(const std::vector<SolitaireGame::RenderItem>& renderList, SwapFrame& frame);
+	Vector2D MouseLocationToWorldLocation(LPARAM lParam);
 	void OnLeftMouseButtonDown(WPARAM wParam, LPARAM lParam);
 	void OnLeftMouseButtonUp(WPARAM wParam, LPARAM lParam);
 	void OnMouseMove(WPARAM wParam, LPARAM lParam);
@@ -69,19 +78,31 @@ private:
 	void OnWindowResized(int width, int height);
 	bool CreateOrAdjustSwapChain(UINT width, UINT height, IDXGIFactory4* factory = nullptr);
 
+	// This is a mapped upload buffer behind one page of a swap frame's upload allocator.
+	struct UploadPage
+	{
+		ComPtr<ID3D12Resource> buffer;
+		UINT8* bufferPtr;
+	};
+
 	struct SwapFrame
 	{
+		SwapFrame() : uploadAllocator(UPLOAD_PAGE_SIZE)
+		{
+			this->fenceEvent = NULL;
+			this->count = 0;
+		}
+
 		ComPtr<ID3D12Resource> renderTarget;
 		ComPtr<ID3D12CommandAllocator> commandAllocator;
 		HANDLE fenceEvent;
 		ComPtr<ID3D12Fence> fence;
 		UINT64 count;
-	};
 
-	struct CardTexture
-	{
-		ComPtr<ID3D12Resource> texture;
-		UINT srvOffset;
+		// Everything the CPU writes for the GPU to read while drawing the frame comes from here.
+		// It's only reset once the GPU is done with the frame, so nothing in use is ever overwritten.
+		LinearAllocator uploadAllocator;
+		std::vector<UploadPage> uploadPageArray;
 	};
 
 	struct CardVertex
@@ -92,11 +113,12 @@ private:
 
 	// In practics, the values that go into a constants buffer change each frame,
 	// but they're called constants, because they're constant for the life of a
-	// vertex or pixel shader in one particular draw call.
-	struct CardConstantsBuffer
+	// vertex or pixel shader in one particular draw call.  These few are passed
+	// in the root signature, so they need no buffer or padding.
+	struct ViewConstants
 	{
-		DirectX::XMMATRIX objToProj;		// This is an object-space to projection-space matrix.
-		UINT8 pad[192];			// Pad the buffer so that its size is a multiple of 256 bytes.  This is a requirement.
+		DirectX::XMFLOAT4X4 worldToProj;
+		UINT firstInstance;		// SV_InstanceID always counts from zero, whatever instance a draw starts on.
 	};
 
 	HWND windowHandle;
@@ -115,24 +137,20 @@ private:
 	HANDLE generalFenceEvent;
 	ComPtr<ID3D12Fence> generalFence;
 	UINT64 generalCount;
-	std::unordered_map<std::string, CardTexture> cardTextureMap;
+	ComPtr<ID3D12Resource> cardTextureArray;
 	ComPtr<ID3D12Resource> cardVertexBuffer;
 	D3D12_VERTEX_BUFFER_VIEW cardVertexBufferView;
-	std::shared_ptr<SolitaireGame> cardGame;
-	std::shared_ptr<SolitaireGame> cardGameClone;
-	std::list<std::shared_ptr<SolitaireGame>> gameHistoryList;
-	std::list<std::shared_ptr<SolitaireGame>> gameFutureList;
-	ComPtr<ID3D12Resource> cardConstantsBuffer;
-	ComPtr<ID3D12DescriptorHeap> cbvHeap;
-	UINT maxCardDrawCallsPerSwapFrame;
-	UINT8* cardConstantsBufferPtr;
+	GameController gameController;
+	RenderCommandList renderCommandList;
+	std::vector<SolitaireGame::RenderItem> renderList;
 	DirectX::XMMATRIX worldToProj;
 	Box worldExtents;
 	Box adjustedWorldExtents;
 	Box cardSize;
 	Clock clock;
-	std::list<double> tickTimeList;
+	double tickTimeArray[TICKS_PER_FPS_PROFILE];
 	UINT64 tickCount;
+	FrameAllocationReport frameAllocationReport;
 	bool mouseCaptured;
-	Clock cardsNeededClock;
+	Clock inputClock;
 };
\ No newline at end of file
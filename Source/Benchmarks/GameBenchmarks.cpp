@@ -0,0 +1,348 @@
+#include "SolitaireGames/KlondikeSolitaireGame.h"
+#include "SolitaireGames/FreeCellSolitaireGame.h"
+#include "SolitaireGames/SpiderSolitaireGame.h"
+#include "BoxArray.h"
+#include "RenderCommandList.h"
+#include "LinearAllocator.h"
+#include <benchmark/benchmark.h>
+#include "AllocationTracker.h"
+#include <unordered_map>
+
+// Every game here is dealt from a fixed seed so that numbers from different commits
+// compare like with like.  Run with --benchmark_out=results.json to keep a record.
+#define BENCHMARK_SEED		20240101
+
+// Every heap allocation made by the benchmarks is counted, since AllocationCounting.cpp is built in.
+// This reports the allocations made per iteration since the count was taken.
+static void ReportAllocations(benchmark::State& state, uint64_t startAllocationCount)
+{
+	uint64_t count = AllocationTracker::GetAllocationCount() - startAllocationCount;
+	state.counters["allocs/frame"] = benchmark::Counter(double(count), benchmark::Counter::kAvgIterations);
+}
+
+// This makes the protected hit test reachable from the benchmarks.
+class BenchmarkSpiderGame : public SpiderSolitaireGame
+{
+public:
+	BenchmarkSpiderGame(const Box& worldExtents, const Box& cardSize) : SpiderSolitaireGame(worldExtents, cardSize, DifficultyLevel::LOW)
+	{
+	}
+
+	using SolitaireGame::FindCardAndPile;
+};
+
+// This is a king down to an ace in alternating colors, face-up.
+static void MakeRun(SolitaireGame::CascadingCardPile& cardPile)
+{
+	for (int i = int(SolitaireGame::Card::KING); i >= int(SolitaireGame::Card::ACE); i--)
+	{
+		SolitaireGame::Card::Suit suit = (i % 2 == 0) ? SolitaireGame::Card::SPADES : SolitaireGame::Card::HEARTS;
+		cardPile.AddCard(SolitaireGame::Card(SolitaireGame::Card::Value(i), suit));
+	}
+}
+
+template<typename GameType>
+static void BenchmarkNewGame(benchmark::State& state, GameType& game)
+{
+	for (auto _ : state)
+	{
+		game.NewGame(BENCHMARK_SEED);
+		benchmark::DoNotOptimize(game.GetHash());
+	}
+}
+
+static void BM_NewGameKlondike(benchmark::State& state)
+{
+	KlondikeSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize());
+	BenchmarkNewGame(state, game);
+}
+
+BENCHMARK(BM_NewGameKlondike);
+
+static void BM_NewGameFreeCell(benchmark::State& state)
+{
+	FreeCellSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize());
+	BenchmarkNewGame(state, game);
+}
+
+BENCHMARK(BM_NewGameFreeCell);
+
+static void BM_NewGameSpider(benchmark::State& state)
+{
+	SpiderSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize(), SpiderSolitaireGame::DifficultyLevel::LOW);
+	BenchmarkNewGame(state, game);
+}
+
+BENCHMARK(BM_NewGameSpider);
+
+static void BM_Clone(benchmark::State& state)
+{
+	SpiderSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize(), SpiderSolitaireGame::DifficultyLevel::LOW);
+	game.NewGame(BENCHMARK_SEED);
+	for (auto _ : state)
+	{
+		std::shared_ptr<SolitaireGame> clone = game.Clone();
+		benchmark::DoNotOptimize(clone.get());
+	}
+}
+
+BENCHMARK(BM_Clone);
+
+static void BM_GenerateRenderList(benchmark::State& state)
+{
+	SpiderSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize(), SpiderSolitaireGame::DifficultyLevel::LOW);
+	game.NewGame(BENCHMARK_SEED);
+	std::vector<SolitaireGame::RenderItem> renderList;
+	for (auto _ : state)
+	{
+		renderList.clear();
+		game.GenerateRenderList(renderList);
+		benchmark::DoNotOptimize(renderList.data());
+	}
+}
+
+BENCHMARK(BM_GenerateRenderList);
+
+static void BM_RecordRenderCommands(benchmark::State& state)
+{
+	SpiderSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize(), SpiderSolitaireGame::DifficultyLevel::LOW);
+	game.NewGame(BENCHMARK_SEED);
+	std::vector<SolitaireGame::RenderItem> renderList;
+	game.GenerateRenderList(renderList);
+
+	RenderCommandList renderCommandList;
+	Box cardSize = SolitaireGame::MakeCardSize();
+
+	// TestRenderCommandList() checks what this records.  Recording once first grows the arrays.
+	renderCommandList.RecordCards(renderList, cardSize);
+
+	uint64_t startAllocationCount = AllocationTracker::GetAllocationCount();
+	for (auto _ : state)
+	{
+		renderCommandList.Reset();
+		renderCommandList.RecordCards(renderList, cardSize);
+		benchmark::DoNotOptimize(renderCommandList.GetInstanceArray().data());
+	}
+
+	ReportAllocations(state, startAllocationCount);
+}
+
+BENCHMARK(BM_RecordRenderCommands);
+
+// This is how each card found its texture every frame before cards numbered their textures:
+// by building the name of the texture and looking it up in a map.  A FreeCell deal has every
+// card face-up, and most of their names are too long to fit in a string without allocating.
+static void BM_CardTexturesByRenderKey(benchmark::State& state)
+{
+	FreeCellSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize());
+	game.NewGame(BENCHMARK_SEED);
+	std::vector<SolitaireGame::RenderItem> renderList;
+	game.GenerateRenderList(renderList);
+
+	std::vector<std::string> renderKeyArray;
+	SolitaireGame::Card::GetAllRenderKeys(renderKeyArray);
+	std::unordered_map<std::string, int> textureMap;
+	for (int i = 0; i < int(renderKeyArray.size()); i++)
+		textureMap.insert(std::pair(renderKeyArray[i], i));
+
+	uint64_t startAllocationCount = AllocationTracker::GetAllocationCount();
+	for (auto _ : state)
+	{
+		int textureIndexSum = 0;
+		for (const SolitaireGame::RenderItem& renderItem : renderList)
+		{
+			auto pair = textureMap.find(renderItem.card.GetRenderKey());
+			if (pair != textureMap.end())
+				textureIndexSum += pair->second;
+		}
+		benchmark::DoNotOptimize(textureIndexSum);
+	}
+
+	ReportAllocations(state, startAllocationCount);
+}
+
+BENCHMARK(BM_CardTexturesByRenderKey);
+
+static void BM_CardTexturesByIndex(benchmark::State& state)
+{
+	FreeCellSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize());
+	game.NewGame(BENCHMARK_SEED);
+	std::vector<SolitaireGame::RenderItem> renderList;
+	game.GenerateRenderList(renderList);
+
+	uint64_t startAllocationCount = AllocationTracker::GetAllocationCount();
+	for (auto _ : state)
+	{
+		int textureIndexSum = 0;
+		for (const SolitaireGame::RenderItem& renderItem : renderList)
+			textureIndexSum += renderItem.card.GetTextureIndex();
+		benchmark::DoNotOptimize(textureIndexSum);
+	}
+
+	ReportAllocations(state, startAllocationCount);
+}
+
+BENCHMARK(BM_CardTexturesByIndex);
+
+static void BM_LinearAllocator(benchmark::State& state)
+{
+	// TestLinearAllocator() checks the space this hands out.  This is a frame's worth of
+	// constants buffers for a two-deck game, as the per-card path would allocate them.
+	LinearAllocator allocator(65536);
+	for (auto _ : state)
+	{
+		allocator.Reset();
+		for (int i = 0; i < 104; i++)
+			benchmark::DoNotOptimize(allocator.Allocate(256, 256));
+	}
+}
+
+BENCHMARK(BM_LinearAllocator);
+
+static void BM_FindCardAndPile(benchmark::State& state)
+{
+	BenchmarkSpiderGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize());
+	game.NewGame(BENCHMARK_SEED);
+
+	// Aim at the middle of the top card of the last pile, the worst case for the search.
+	Vector2D point = game.GetPile(SpiderSolitaireGame::NUM_TABLEAU_PILES - 1)->visualArray.back().position + SolitaireGame::MakeCardSize().GetCenter();
+	for (auto _ : state)
+	{
+		int foundPileIndex = -1;
+		int foundCardOffset = -1;
+		benchmark::DoNotOptimize(game.FindCardAndPile(point, foundPileIndex, foundCardOffset));
+		benchmark::DoNotOptimize(foundCardOffset);
+	}
+}
+
+BENCHMARK(BM_FindCardAndPile);
+
+static void BM_LayoutCards(benchmark::State& state)
+{
+	SolitaireGame::CascadingCardPile cardPile;
+	MakeRun(cardPile);
+	Box cardSize = SolitaireGame::MakeCardSize();
+	for (auto _ : state)
+	{
+		cardPile.LayoutCards(cardSize);
+		benchmark::DoNotOptimize(cardPile.visualArray.data());
+	}
+}
+
+BENCHMARK(BM_LayoutCards);
+
+static void BM_DragCards(benchmark::State& state)
+{
+	SpiderSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize(), SpiderSolitaireGame::DifficultyLevel::LOW);
+	game.NewGame(BENCHMARK_SEED);
+
+	// Pick up the top card of the first pile and wave it back and forth across the table.
+	Vector2D grabPoint = game.GetPile(0)->visualArray.back().position + SolitaireGame::MakeCardSize().GetCenter();
+	game.OnMouseGrabAt(grabPoint);
+
+	int i = 0;
+	for (auto _ : state)
+	{
+		game.OnMouseMove(grabPoint + Vector2D(float(i++ % 100), 0.0f));
+		benchmark::DoNotOptimize(game.GetHash());
+	}
+
+	game.OnMouseReleaseAt(grabPoint);
+}
+
+BENCHMARK(BM_DragCards);
+
+static void BM_CardsInOrder(benchmark::State& state)
+{
+	SolitaireGame::CascadingCardPile cardPile;
+	MakeRun(cardPile);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(cardPile.CardsInOrder(0, int(cardPile.cardArray.size()) - 1));
+}
+
+BENCHMARK(BM_CardsInOrder);
+
+static void BM_CardsAlternateColor(benchmark::State& state)
+{
+	SolitaireGame::CascadingCardPile cardPile;
+	MakeRun(cardPile);
+	for (auto _ : state)
+		benchmark::DoNotOptimize(cardPile.CardsAlternateColor(0, int(cardPile.cardArray.size()) - 1));
+}
+
+BENCHMARK(BM_CardsAlternateColor);
+
+static void BM_SpiderTick(benchmark::State& state)
+{
+	SpiderSolitaireGame game(SolitaireGame::MakeWorldExtents(), SolitaireGame::MakeCardSize(), SpiderSolitaireGame::DifficultyLevel::LOW);
+	game.NewGame(BENCHMARK_SEED);
+	while (game.OnCardsNeeded())
+		;
+
+	// Let the deals land so that only the scan for completed runs is left each frame.
+	for (int i = 0; i < 100; i++)
+		game.Tick(1.0);
+
+	for (auto _ : state)
+		game.Tick(1.0 / 60.0);
+}
+
+BENCHMARK(BM_SpiderTick);
+
+// These are the given number of cards cascading down the table in columns, and a point on the bottom card.
+static void MakeCardBoxes(int boxCount, std::vector<Box>& boxArray, Vector2D& point)
+{
+	Box cardSize = SolitaireGame::MakeCardSize();
+	for (int i = 0; i < boxCount; i++)
+	{
+		Vector2D position(float((i % 10) * 15), float(80 - (i / 10) * 3));
+		Box box;
+		box.min = cardSize.min + position;
+		box.max = cardSize.max + position;
+		boxArray.push_back(box);
+	}
+
+	point = boxArray[0].GetCenter();
+}
+
+static void BM_BoxContainsPointScalar(benchmark::State& state)
+{
+	std::vector<Box> boxArray;
+	Vector2D point;
+	MakeCardBoxes(int(state.range(0)), boxArray, point);
+
+	for (auto _ : state)
+	{
+		int foundIndex = -1;
+		for (int i = int(boxArray.size()) - 1; i >= 0; i--)
+		{
+			if (boxArray[i].ContainsPoint(point))
+			{
+				foundIndex = i;
+				break;
+			}
+		}
+
+		benchmark::DoNotOptimize(foundIndex);
+	}
+}
+
+BENCHMARK(BM_BoxContainsPointScalar)->Arg(8)->Arg(64)->Arg(512);
+
+static void BM_BoxArrayFindLast(benchmark::State& state)
+{
+	std::vector<Box> boxArray;
+	Vector2D point;
+	MakeCardBoxes(int(state.range(0)), boxArray, point);
+
+	BoxArray batch;
+	for (const Box& box : boxArray)
+		batch.Add(box);
+
+	for (auto _ : state)
+		benchmark::DoNotOptimize(batch.FindLast(point));
+}
+
+BENCHMARK(BM_BoxArrayFindLast)->Arg(8)->Arg(64)->Arg(512);
+
+BENCHMARK_MAIN();
\ No newline at end of file
@@ -1,11 +1,8 @@
 #include "Box.h"
-
-using namespace DirectX;
+#include <assert.h>
 
 Box::Box()
 {
-	this->min = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-	this->max = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
 }
 
 Box::Box(const Box& box)
@@ -26,12 +23,12 @@ void Box::operator=(const Box& box)
 
 double Box::GetWidth() const
 {
-	return XMVectorGetX(this->max) - XMVectorGetX(this->min);
+	return this->max.x - this->min.x;
 }
 
 double Box::GetHeight() const
 {
-	return XMVectorGetY(this->max) - XMVectorGetY(this->min);
+	return this->max.y - this->min.y;
 }
 
 double Box::GetAspectRatio() const
@@ -43,14 +40,14 @@ void Box::ExpandToMatchAspectRatio(double aspectRatio)
 {
 	double currentAspectRatio = this->GetAspectRatio();
 
-	XMVECTOR delta = XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f);
+	Vector2D delta(0.0f, 0.0f);
 	if (currentAspectRatio < aspectRatio)
-		delta = XMVectorSet((this->GetHeight() * aspectRatio - this->GetWidth()) / 2.0, 0.0f, 0.0f, 1.0f);
+		delta = Vector2D(float((this->GetHeight() * aspectRatio - this->GetWidth()) / 2.0), 0.0f);
 	else if (currentAspectRatio > aspectRatio)
-		delta = XMVectorSet(0.0f, (this->GetWidth() / aspectRatio - this->GetHeight()) / 2.0, 0.0f, 1.0f);
+		delta = Vector2D(0.0f, float((this->GetWidth() / aspectRatio - this->GetHeight()) / 2.0));
 
-	this->min = XMVectorSubtract(this->min, delta);
-	this->max = XMVectorAdd(this->max, delta);
+	this->min -= delta;
+	this->max += delta;
 
 #if defined _DEBUG
 	double newAspectRatio = this->GetAspectRatio();
@@ -59,53 +56,49 @@ void Box::ExpandToMatchAspectRatio(double aspectRatio)
 #endif
 }
 
-XMVECTOR Box::PointToUVs(XMVECTOR point) const
+Vector2D Box::PointToUVs(const Vector2D& point) const
 {
-	return XMVectorSet(
-		(XMVectorGetX(point) - XMVectorGetX(this->min)) / this->GetWidth(),
-		(XMVectorGetY(point) - XMVectorGetY(this->min)) / this->GetHeight(),
-		0.0f,
-		1.0f
+	return Vector2D(
+		float((point.x - this->min.x) / this->GetWidth()),
+		float((point.y - this->min.y) / this->GetHeight())
 	);
 }
 
-XMVECTOR Box::PointFromUVs(XMVECTOR uvs) const
+Vector2D Box::PointFromUVs(const Vector2D& uvs) const
 {
-	return XMVectorSet(
-		XMVectorGetX(min) + XMVectorGetX(uvs) * this->GetWidth(),
-		XMVectorGetY(min) + XMVectorGetY(uvs) * this->GetHeight(),
-		0.0f,
-		1.0f
+	return Vector2D(
+		float(this->min.x + uvs.x * this->GetWidth()),
+		float(this->min.y + uvs.y * this->GetHeight())
 	);
 }
 
-bool Box::ContainsPoint(DirectX::XMVECTOR point) const
+bool Box::ContainsPoint(const Vector2D& point) const
 {
-	if (XMVectorGetX(point) < XMVectorGetX(this->min))
+	if (point.x < this->min.x)
 		return false;
 
-	if (XMVectorGetX(point) > XMVectorGetX(this->max))
+	if (point.x > this->max.x)
 		return false;
 
-	if (XMVectorGetY(point) < XMVectorGetY(this->min))
+	if (point.y < this->min.y)
 		return false;
 
-	if (XMVectorGetY(point) > XMVectorGetY(this->max))
+	if (point.y > this->max.y)
 		return false;
 
 	return true;
 }
 
-XMVECTOR Box::GetCenter() const
+Vector2D Box::GetCenter() const
 {
 	return (this->min + this->max) / 2.0f;
 }
 
 void Box::ScaleAboutCenter(double scaleFactor)
 {
-	XMVECTOR center = this->GetCenter();
-	XMVECTOR delta = this->max - center;
-	delta *= scaleFactor;
+	Vector2D center = this->GetCenter();
+	Vector2D delta = this->max - center;
+	delta *= float(scaleFactor);
 	this->min = center - delta;
 	this->max = center + delta;
 }
\ No newline at end of file
@@ -1,6 +1,6 @@
 #pragma once
 
-#include <DirectXMath.h>
+#include "Vector2D.h"
 
 class Box
 {
@@ -14,15 +14,15 @@ public:
 	double GetWidth() const;
 	double GetHeight() const;
 	double GetAspectRatio() const;
-	DirectX::XMVECTOR PointToUVs(DirectX::XMVECTOR point) const;
-	DirectX::XMVECTOR PointFromUVs(DirectX::XMVECTOR uvs) const;
-	bool ContainsPoint(DirectX::XMVECTOR point) const;
-	DirectX::XMVECTOR GetCenter() const;
+	Vector2D PointToUVs(const Vector2D& point) const;
+	Vector2D PointFromUVs(const Vector2D& uvs) const;
+	bool ContainsPoint(const Vector2D& point) const;
+	Vector2D GetCenter() const;
 	void ScaleAboutCenter(double scaleFactor);
 
 	void ExpandToMatchAspectRatio(double aspectRatio);
 
 public:
-	DirectX::XMVECTOR min;
-	DirectX::XMVECTOR max;
+	Vector2D min;
+	Vector2D max;
 };
\ No newline at end of file
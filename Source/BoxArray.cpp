@@ -0,0 +1,166 @@
+#include "BoxArray.h"
+#include <assert.h>
+#include <limits>
+
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#	define BOX_ARRAY_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	include <emmintrin.h>
+#	define BOX_ARRAY_SSE2
+#endif
+
+BoxArray::BoxArray()
+{
+	this->count = 0;
+}
+
+/*virtual*/ BoxArray::~BoxArray()
+{
+}
+
+void BoxArray::Clear()
+{
+	this->minXArray.clear();
+	this->minYArray.clear();
+	this->maxXArray.clear();
+	this->maxYArray.clear();
+	this->count = 0;
+}
+
+void BoxArray::Add(const Box& box)
+{
+	// Padding is an inside-out box, which nothing can be inside of or overlap.
+	if (this->count % BOX_ARRAY_LANES == 0)
+	{
+		const float infinity = std::numeric_limits<float>::infinity();
+		this->minXArray.resize(this->count + BOX_ARRAY_LANES, infinity);
+		this->minYArray.resize(this->count + BOX_ARRAY_LANES, infinity);
+		this->maxXArray.resize(this->count + BOX_ARRAY_LANES, -infinity);
+		this->maxYArray.resize(this->count + BOX_ARRAY_LANES, -infinity);
+	}
+
+	this->Set(this->count++, box);
+}
+
+void BoxArray::Set(int i, const Box& box)
+{
+	assert(0 <= i && i < int(this->minXArray.size()));
+
+	this->minXArray[i] = box.min.x;
+	this->minYArray[i] = box.min.y;
+	this->maxXArray[i] = box.max.x;
+	this->maxYArray[i] = box.max.y;
+}
+
+Box BoxArray::Get(int i) const
+{
+	assert(0 <= i && i < this->count);
+
+	Box box;
+	box.min = Vector2D(this->minXArray[i], this->minYArray[i]);
+	box.max = Vector2D(this->maxXArray[i], this->maxYArray[i]);
+	return box;
+}
+
+void BoxArray::RemoveAt(int i)
+{
+	assert(0 <= i && i < this->count);
+
+	// Keep the order, as it's what says which box is on top.
+	for (int j = i + 1; j < this->count; j++)
+		this->Set(j - 1, this->Get(j));
+
+	Box padding;
+	padding.min = Vector2D(std::numeric_limits<float>::infinity(), std::numeric_limits<float>::infinity());
+	padding.max = Vector2D(-std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity());
+	this->Set(--this->count, padding);
+}
+
+int BoxArray::GetCount() const
+{
+	return this->count;
+}
+
+int BoxArray::FindLast(const Vector2D& point) const
+{
+	Box pointBox;
+	pointBox.min = point;
+	pointBox.max = point;
+
+	// Search from the end so that the first hit found is the one on top.
+	for (int first = int(this->minXArray.size()) - BOX_ARRAY_LANES; first >= 0; first -= BOX_ARRAY_LANES)
+	{
+		unsigned int mask = this->OverlapMask(first, pointBox);
+		if (mask != 0)
+		{
+			int lane = BOX_ARRAY_LANES - 1;
+			while ((mask & (1 << lane)) == 0)
+				lane--;
+
+			return first + lane;
+		}
+	}
+
+	return -1;
+}
+
+void BoxArray::FindOverlapping(const Box& box, std::vector<int>& indexArray) const
+{
+	for (int first = 0; first < int(this->minXArray.size()); first += BOX_ARRAY_LANES)
+	{
+		unsigned int mask = this->OverlapMask(first, box);
+		for (int lane = 0; mask != 0; lane++, mask >>= 1)
+			if ((mask & 1) != 0)
+				indexArray.push_back(first + lane);
+	}
+}
+
+unsigned int BoxArray::OverlapMask(int first, const Box& box) const
+{
+	assert(first % BOX_ARRAY_LANES == 0 && first + BOX_ARRAY_LANES <= int(this->minXArray.size()));
+
+	// A box overlaps another unless it's entirely off to one side of it.
+#if defined(BOX_ARRAY_AVX2)
+	__m256 overlap = _mm256_and_ps(
+		_mm256_and_ps(
+			_mm256_cmp_ps(_mm256_loadu_ps(&this->minXArray[first]), _mm256_set1_ps(box.max.x), _CMP_LE_OQ),
+			_mm256_cmp_ps(_mm256_loadu_ps(&this->maxXArray[first]), _mm256_set1_ps(box.min.x), _CMP_GE_OQ)),
+		_mm256_and_ps(
+			_mm256_cmp_ps(_mm256_loadu_ps(&this->minYArray[first]), _mm256_set1_ps(box.max.y), _CMP_LE_OQ),
+			_mm256_cmp_ps(_mm256_loadu_ps(&this->maxYArray[first]), _mm256_set1_ps(box.min.y), _CMP_GE_OQ)));
+
+	return (unsigned int)_mm256_movemask_ps(overlap);
+#elif defined(BOX_ARRAY_SSE2)
+	__m128 maxX = _mm_set1_ps(box.max.x);
+	__m128 minX = _mm_set1_ps(box.min.x);
+	__m128 maxY = _mm_set1_ps(box.max.y);
+	__m128 minY = _mm_set1_ps(box.min.y);
+
+	unsigned int mask = 0;
+	for (int half = 0; half < BOX_ARRAY_LANES; half += 4)
+	{
+		int i = first + half;
+		__m128 overlap = _mm_and_ps(
+			_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&this->minXArray[i]), maxX), _mm_cmpge_ps(_mm_loadu_ps(&this->maxXArray[i]), minX)),
+			_mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(&this->minYArray[i]), maxY), _mm_cmpge_ps(_mm_loadu_ps(&this->maxYArray[i]), minY)));
+
+		mask |= (unsigned int)_mm_movemask_ps(overlap) << half;
+	}
+
+	return mask;
+#else
+	unsigned int mask = 0;
+	for (int lane = 0; lane < BOX_ARRAY_LANES; lane++)
+	{
+		int i = first + lane;
+		if (this->minXArray[i] <= box.max.x && this->maxXArray[i] >= box.min.x &&
+			this->minYArray[i] <= box.max.y && this->maxYArray[i] >= box.min.y)
+		{
+			mask |= 1 << lane;
+		}
+	}
+
+	return mask;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include "Box.h"
+
+// This many boxes are tested at once, and the arrays are always padded out to a multiple of it.
+#define BOX_ARRAY_LANES		8
+
+// This holds boxes as four separate arrays of their edges, rather than an array of boxes,
+// so that a point can be tested against several of them at once with SIMD instructions:
+// eight at a time with AVX2, four with SSE2, and one at a time anywhere else.  A box
+// contains the points on its edges, just as Box::ContainsPoint() has it.
+class BoxArray
+{
+public:
+	BoxArray();
+	virtual ~BoxArray();
+
+	void Clear();
+	void Add(const Box& box);
+	void Set(int i, const Box& box);
+	Box Get(int i) const;
+	void RemoveAt(int i);
+	int GetCount() const;
+
+	// This is the index of the last box containing the point, the last being taken as the
+	// top-most as boxes are drawn in order, or -1 if no box contains it.
+	int FindLast(const Vector2D& point) const;
+
+	// This appends the index of every box that overlaps the given one, in order.
+	void FindOverlapping(const Box& box, std::vector<int>& indexArray) const;
+
+private:
+	// This has a bit set for each of the lanes from the given one on that overlap the box, the first lane lowest.
+	unsigned int OverlapMask(int first, const Box& box) const;
+
+	std::vector<float> minXArray;
+	std::vector<float> minYArray;
+	std::vector<float> maxXArray;
+	std::vector<float> maxYArray;
+	int count;
+};
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "Clock.h"
-#include <Windows.h>
-#include <sysinfoapi.h>
+#include <chrono>
 
 Clock::Clock()
 {
@@ -23,14 +22,9 @@ bool Clock::NeverBeenReset() const
 
 uint64_t Clock::GetCurrentSystemTime() const
 {
-	FILETIME fileTime{};
-	::GetSystemTimePreciseAsFileTime(&fileTime);
-
-	ULARGE_INTEGER largeInteger{};
-	largeInteger.LowPart = fileTime.dwLowDateTime;
-	largeInteger.HighPart = fileTime.dwHighDateTime;
-
-	return largeInteger.QuadPart;
+	// Use the monotonic clock so that elapsed times never go negative if the wall-clock gets adjusted.
+	auto timeSinceEpoch = std::chrono::steady_clock::now().time_since_epoch();
+	return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(timeSinceEpoch).count();
 }
 
 uint64_t Clock::GetElapsedTime(bool reset /*= false*/)
@@ -44,14 +38,14 @@ uint64_t Clock::GetElapsedTime(bool reset /*= false*/)
 
 double Clock::GetCurrentTimeMilliseconds(bool reset /*= false*/)
 {
-	long double oneHundredNanoSecondTicks = (long double)this->GetElapsedTime(reset);
-	long double milliseconds = oneHundredNanoSecondTicks / 10000.0;
+	long double nanoseconds = (long double)this->GetElapsedTime(reset);
+	long double milliseconds = nanoseconds / 1000000.0;
 	return double(milliseconds);
 }
 
 double Clock::GetCurrentTimeSeconds(bool reset /*= false*/)
 {
-	long double oneHundredNanoSecondTicks = (long double)this->GetElapsedTime(reset);
-	long double seconds = oneHundredNanoSecondTicks / 10000000.0;
+	long double nanoseconds = (long double)this->GetElapsedTime(reset);
+	long double seconds = nanoseconds / 1000000000.0;
 	return double(seconds);
 }
\ No newline at end of file
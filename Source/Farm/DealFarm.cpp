@@ -0,0 +1,189 @@
+#include "DealFarm.h"
+#include "SolitaireGames/KlondikeSolitaireGame.h"
+#include "SolitaireGames/FreeCellSolitaireGame.h"
+#include "SolitaireGames/SpiderSolitaireGame.h"
+#include "Solvers/KlondikeSolver.h"
+#include "Solvers/FreeCellSolver.h"
+#include "Solvers/SpiderSolver.h"
+#include "Clock.h"
+#include <thread>
+#include <fstream>
+
+DealFarm::DealFarm()
+{
+	this->variant = Variant::KLONDIKE;
+	this->firstSeed = 0;
+	this->nodeLimit = 0;
+}
+
+/*virtual*/ DealFarm::~DealFarm()
+{
+}
+
+/*static*/ bool DealFarm::LookupVariant(const std::string& variantName, Variant& variant)
+{
+	if (variantName == "klondike")
+		variant = Variant::KLONDIKE;
+	else if (variantName == "freecell")
+		variant = Variant::FREECELL;
+	else if (variantName == "spider-low")
+		variant = Variant::SPIDER_LOW;
+	else if (variantName == "spider-medium")
+		variant = Variant::SPIDER_MEDIUM;
+	else if (variantName == "spider-hard")
+		variant = Variant::SPIDER_HARD;
+	else
+		return false;
+
+	return true;
+}
+
+void DealFarm::Run(Variant variant, uint64_t firstSeed, uint64_t lastSeed, int nodeLimit, int threadCount)
+{
+	this->variant = variant;
+	this->firstSeed = firstSeed;
+	this->nodeLimit = nodeLimit;
+
+	uint32_t seedCount = uint32_t(lastSeed - firstSeed + 1);
+	this->resultArray.clear();
+	this->resultArray.resize(seedCount);
+
+	if (threadCount < 1)
+		threadCount = 1;
+
+	// Hand each thread a contiguous share of the batches.
+	std::vector<WorkQueue> workQueueArray(threadCount);
+	this->workQueueArray.swap(workQueueArray);
+	uint32_t batchCount = (seedCount + BATCH_SIZE - 1) / BATCH_SIZE;
+	for (uint32_t i = 0; i < batchCount; i++)
+	{
+		Batch batch;
+		batch.firstSeed = firstSeed + i * BATCH_SIZE;
+		batch.seedCount = (seedCount - i * BATCH_SIZE < BATCH_SIZE) ? (seedCount - i * BATCH_SIZE) : uint32_t(BATCH_SIZE);
+		this->workQueueArray[uint64_t(i) * threadCount / batchCount].batchDeque.push_back(batch);
+	}
+
+	std::vector<std::thread> threadArray;
+	for (int i = 0; i < threadCount; i++)
+		threadArray.push_back(std::thread(&DealFarm::WorkerThread, this, i));
+
+	for (std::thread& thread : threadArray)
+		thread.join();
+
+	this->workQueueArray.clear();
+}
+
+void DealFarm::WorkerThread(int workerIndex)
+{
+	// The deals are laid out just as the game would lay them out.
+	Box worldExtents = SolitaireGame::MakeWorldExtents();
+	Box cardSize = SolitaireGame::MakeCardSize();
+
+	switch (this->variant)
+	{
+		case Variant::KLONDIKE:
+		{
+			KlondikeSolitaireGame game(worldExtents, cardSize);
+			this->SolveBatches<KlondikeSolitaireGame, KlondikeSolver>(workerIndex, game);
+			break;
+		}
+		case Variant::FREECELL:
+		{
+			FreeCellSolitaireGame game(worldExtents, cardSize);
+			this->SolveBatches<FreeCellSolitaireGame, FreeCellSolver>(workerIndex, game);
+			break;
+		}
+		case Variant::SPIDER_LOW:
+		case Variant::SPIDER_MEDIUM:
+		case Variant::SPIDER_HARD:
+		{
+			SpiderSolitaireGame::DifficultyLevel difficultyLevel = SpiderSolitaireGame::DifficultyLevel(int(this->variant) - int(Variant::SPIDER_LOW));
+			SpiderSolitaireGame game(worldExtents, cardSize, difficultyLevel);
+			this->SolveBatches<SpiderSolitaireGame, SpiderSolver>(workerIndex, game);
+			break;
+		}
+	}
+}
+
+template<typename GameType, typename SolverType>
+void DealFarm::SolveBatches(int workerIndex, GameType& game)
+{
+	SolverType solver;
+	solver.SetNodeLimit(this->nodeLimit);
+
+	std::vector<SolitaireGame::Move> solution;
+	Clock clock;
+
+	Batch batch;
+	while (this->TakeBatch(workerIndex, batch))
+	{
+		for (uint64_t seed = batch.firstSeed; seed < batch.firstSeed + batch.seedCount; seed++)
+		{
+			game.NewGame(seed);
+
+			clock.Reset();
+			typename SolverType::Result result = solver.Solve(&game, solution);
+
+			DealResult& dealResult = this->resultArray[size_t(seed - this->firstSeed)];
+			dealResult.seed = seed;
+			dealResult.milliseconds = float(clock.GetCurrentTimeMilliseconds());
+			dealResult.nodeCount = uint32_t(solver.GetNodeCount());
+			if (result == SolverType::Result::SOLVED)
+				dealResult.outcome = Outcome::WON;
+			else if (result == SolverType::Result::UNSOLVABLE)
+				dealResult.outcome = Outcome::LOST;
+			else
+				dealResult.outcome = Outcome::TIMEOUT;
+		}
+	}
+}
+
+bool DealFarm::TakeBatch(int workerIndex, Batch& batch)
+{
+	// Take the next of our own batches from the front, in seed order.
+	WorkQueue& ownQueue = this->workQueueArray[workerIndex];
+	{
+		std::lock_guard<std::mutex> lock(ownQueue.mutex);
+		if (ownQueue.batchDeque.size() > 0)
+		{
+			batch = ownQueue.batchDeque.front();
+			ownQueue.batchDeque.pop_front();
+			return true;
+		}
+	}
+
+	// Otherwise steal the last batch from the back of someone else's queue.
+	for (int i = 1; i < int(this->workQueueArray.size()); i++)
+	{
+		WorkQueue& otherQueue = this->workQueueArray[(workerIndex + i) % this->workQueueArray.size()];
+		std::lock_guard<std::mutex> lock(otherQueue.mutex);
+		if (otherQueue.batchDeque.size() > 0)
+		{
+			batch = otherQueue.batchDeque.back();
+			otherQueue.batchDeque.pop_back();
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool DealFarm::WriteResults(const std::string& filePath) const
+{
+	std::ofstream fileStream(filePath, std::ios::out | std::ios::trunc);
+	if (!fileStream.is_open())
+		return false;
+
+	static const char* outcomeName[] = { "won", "lost", "timeout" };
+
+	fileStream << "seed,outcome,nodes,milliseconds\n";
+	for (const DealResult& dealResult : this->resultArray)
+		fileStream << dealResult.seed << "," << outcomeName[dealResult.outcome] << "," << dealResult.nodeCount << "," << dealResult.milliseconds << "\n";
+
+	return fileStream.good();
+}
+
+const std::vector<DealFarm::DealResult>& DealFarm::GetResultArray() const
+{
+	return this->resultArray;
+}
\ No newline at end of file
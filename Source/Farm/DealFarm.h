@@ -0,0 +1,81 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <stdint.h>
+
+// This rates a range of deals of one variant by solving each of them, the work being
+// spread across threads.  Each thread starts with its own share of the seeds, cut into
+// small batches, and steals batches from the back of the others' queues once it runs
+// out, so a thread stuck on a few hard deals doesn't hold up the rest of the range.
+class DealFarm
+{
+public:
+	DealFarm();
+	virtual ~DealFarm();
+
+	enum Variant
+	{
+		KLONDIKE,
+		FREECELL,
+		SPIDER_LOW,
+		SPIDER_MEDIUM,
+		SPIDER_HARD
+	};
+
+	enum Outcome : uint8_t
+	{
+		WON,
+		LOST,
+		TIMEOUT
+	};
+
+	struct DealResult
+	{
+		uint64_t seed;
+		Outcome outcome;
+		uint32_t nodeCount;
+		float milliseconds;
+	};
+
+	static bool LookupVariant(const std::string& variantName, Variant& variant);
+
+	void Run(Variant variant, uint64_t firstSeed, uint64_t lastSeed, int nodeLimit, int threadCount);
+
+	// This writes one line per deal, in seed order: seed,outcome,nodes,milliseconds.
+	bool WriteResults(const std::string& filePath) const;
+
+	const std::vector<DealResult>& GetResultArray() const;
+
+private:
+	enum
+	{
+		BATCH_SIZE = 16
+	};
+
+	struct Batch
+	{
+		uint64_t firstSeed;
+		uint32_t seedCount;
+	};
+
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<Batch> batchDeque;
+	};
+
+	void WorkerThread(int workerIndex);
+	bool TakeBatch(int workerIndex, Batch& batch);
+
+	template<typename GameType, typename SolverType>
+	void SolveBatches(int workerIndex, GameType& game);
+
+	Variant variant;
+	uint64_t firstSeed;
+	int nodeLimit;
+	std::vector<WorkQueue> workQueueArray;
+	std::vector<DealResult> resultArray;
+};
\ No newline at end of file
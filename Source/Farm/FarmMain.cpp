@@ -0,0 +1,58 @@
+#include "DealFarm.h"
+#include "Clock.h"
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+
+// Usage: solitaire-farm <variant> <first seed> <last seed> <node limit> <output file> [thread count]
+int main(int argc, char** argv)
+{
+	if (argc < 6)
+	{
+		fprintf(stderr, "Usage: %s <variant> <first seed> <last seed> <node limit> <output file> [thread count]\n", argv[0]);
+		fprintf(stderr, "Variants: klondike, freecell, spider-low, spider-medium, spider-hard\n");
+		return 1;
+	}
+
+	DealFarm::Variant variant;
+	if (!DealFarm::LookupVariant(argv[1], variant))
+	{
+		fprintf(stderr, "Unknown variant \"%s\".\n", argv[1]);
+		return 1;
+	}
+
+	uint64_t firstSeed = std::strtoull(argv[2], nullptr, 10);
+	uint64_t lastSeed = std::strtoull(argv[3], nullptr, 10);
+	int nodeLimit = std::atoi(argv[4]);
+	if (lastSeed < firstSeed || lastSeed - firstSeed >= UINT32_MAX || nodeLimit <= 0)
+	{
+		fprintf(stderr, "The seed range or node limit is invalid.\n");
+		return 1;
+	}
+
+	int threadCount = (argc > 6) ? std::atoi(argv[6]) : int(std::thread::hardware_concurrency());
+	if (threadCount < 1)
+		threadCount = 1;
+
+	Clock clock;
+	clock.Reset();
+
+	DealFarm farm;
+	farm.Run(variant, firstSeed, lastSeed, nodeLimit, threadCount);
+
+	if (!farm.WriteResults(argv[5]))
+	{
+		fprintf(stderr, "Failed to write \"%s\".\n", argv[5]);
+		return 1;
+	}
+
+	int outcomeCount[3] = { 0, 0, 0 };
+	for (const DealFarm::DealResult& dealResult : farm.GetResultArray())
+		outcomeCount[dealResult.outcome]++;
+
+	printf("%d deals on %d threads in %.1f seconds: %d won, %d lost, %d timed out.\n",
+		int(farm.GetResultArray().size()), threadCount, clock.GetCurrentTimeSeconds(),
+		outcomeCount[DealFarm::Outcome::WON], outcomeCount[DealFarm::Outcome::LOST], outcomeCount[DealFarm::Outcome::TIMEOUT]);
+
+	return 0;
+}
\ No newline at end of file
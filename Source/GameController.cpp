@@ -0,0 +1,269 @@
+#include "GameController.h"
+#include <fstream>
+#include <string.h>
+
+GameController::GameController()
+{
+	this->lastCardsNeededTime = 0.0;
+	this->gameRecordWriter = nullptr;
+}
+
+/*virtual*/ GameController::~GameController()
+{
+}
+
+void GameController::SetGame(std::shared_ptr<SolitaireGame> game)
+{
+	this->EndRecording();
+	this->game = game;
+	this->history.Reset(this->game.get());
+	this->BeginRecording();
+}
+
+void GameController::NewGame()
+{
+	if (this->game.get())
+	{
+		this->EndRecording();
+		this->game->NewGame();
+		this->history.Reset(this->game.get());
+		this->BeginRecording();
+	}
+}
+
+void GameController::NewGame(uint64_t seed)
+{
+	if (this->game.get())
+	{
+		this->EndRecording();
+		this->game->NewGame(seed);
+		this->history.Reset(this->game.get());
+		this->BeginRecording();
+	}
+}
+
+void GameController::Clear()
+{
+	this->EndRecording();
+
+	if (this->game.get())
+		this->game->SetMoveListener(nullptr);
+
+	this->history.Clear();
+	this->game.reset();
+}
+
+void GameController::SetGameRecordWriter(GameRecordWriter* gameRecordWriter)
+{
+	this->EndRecording();
+	this->gameRecordWriter = gameRecordWriter;
+	this->history.SetMoveListener(gameRecordWriter);
+	this->BeginRecording();
+}
+
+bool GameController::SaveGame(const std::string& filePath)
+{
+	GameRecord::Header header;
+	if (!this->game.get() || !GameRecord::DescribeGame(this->game.get(), header))
+		return false;
+
+	this->game->CancelCardMoving();
+
+	std::vector<uint8_t> byteArray(SAVED_GAME_MAGIC, SAVED_GAME_MAGIC + SAVED_GAME_MAGIC_SIZE);
+	GameRecord::WriteVarint(SAVED_GAME_VERSION, byteArray);
+	GameRecord::WriteVarint(uint64_t(header.variant), byteArray);
+	GameRecord::WriteVarint(uint64_t(header.difficultyLevel), byteArray);
+	GameRecord::WriteVarint(header.seed, byteArray);
+
+	this->game->SaveState(byteArray);
+
+	const std::vector<SolitaireGame::Move>& moveArray = this->history.GetMoveArray();
+	GameRecord::WriteVarint(moveArray.size(), byteArray);
+	GameRecord::WriteVarint(uint64_t(this->history.GetCurrentMove()), byteArray);
+	for (const SolitaireGame::Move& move : moveArray)
+		GameRecord::WriteVarint(GameRecord::EncodeMove(move), byteArray);
+
+	std::ofstream fileStream(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!fileStream.is_open())
+		return false;
+
+	fileStream.write((const char*)byteArray.data(), byteArray.size());
+	return fileStream.good();
+}
+
+bool GameController::ResumeGame(const std::string& filePath, const Box& worldExtents, const Box& cardSize)
+{
+	std::vector<uint8_t> byteArray;
+	if (!GameRecordReader::LoadFile(filePath, byteArray) || byteArray.size() < SAVED_GAME_MAGIC_SIZE)
+		return false;
+
+	if (::memcmp(byteArray.data(), SAVED_GAME_MAGIC, SAVED_GAME_MAGIC_SIZE) != 0)
+		return false;
+
+	const uint8_t* data = byteArray.data() + SAVED_GAME_MAGIC_SIZE;
+	const uint8_t* dataEnd = byteArray.data() + byteArray.size();
+
+	uint64_t version = 0, variant = 0, difficultyLevel = 0;
+	GameRecord::Header header;
+	if (!GameRecord::ReadVarint(data, dataEnd, version) || version != SAVED_GAME_VERSION ||
+		!GameRecord::ReadVarint(data, dataEnd, variant) || variant >= GameRecord::Variant::NUM_VARIANTS ||
+		!GameRecord::ReadVarint(data, dataEnd, difficultyLevel) ||
+		!GameRecord::ReadVarint(data, dataEnd, header.seed))
+	{
+		return false;
+	}
+
+	header.variant = GameRecord::Variant(variant);
+	header.difficultyLevel = int(difficultyLevel);
+
+	// The deal sets up the piles, and the saved cards then go into them as they were.
+	std::shared_ptr<SolitaireGame> game = GameRecord::CreateGame(header, worldExtents, cardSize);
+	if (!game.get())
+		return false;
+
+	game->NewGame(header.seed);
+	if (!game->LoadState(data, dataEnd))
+		return false;
+
+	uint64_t moveCount = 0, currentMove = 0;
+	if (!GameRecord::ReadVarint(data, dataEnd, moveCount) || !GameRecord::ReadVarint(data, dataEnd, currentMove) || currentMove > moveCount)
+		return false;
+
+	// Every move takes at least a byte, which bounds the count before anything is allocated for it.
+	if (moveCount > uint64_t(dataEnd - data))
+		return false;
+
+	std::vector<SolitaireGame::Move> moveArray;
+	moveArray.resize(size_t(moveCount));
+	for (SolitaireGame::Move& move : moveArray)
+	{
+		uint64_t value = 0;
+		if (!GameRecord::ReadVarint(data, dataEnd, value) || value > UINT32_MAX || !GameRecord::DecodeMove(uint32_t(value), move))
+			return false;
+	}
+
+	// A file can be damaged and still read back cleanly, so every move is tried out on a
+	// throwaway copy before any is trusted.  Taking back the moves made must lead back to
+	// the deal, and the moves that could be redone must go on from where the game is.
+	std::shared_ptr<SolitaireGame> checkGame = game->Clone();
+	for (int i = int(currentMove) - 1; i >= 0; i--)
+	{
+		if (!checkGame->CanUndoMove(moveArray[i]))
+			return false;
+
+		checkGame->UndoMove(moveArray[i]);
+	}
+
+	std::shared_ptr<SolitaireGame> dealtGame = GameRecord::CreateGame(header, worldExtents, cardSize);
+	dealtGame->NewGame(header.seed);
+	if (checkGame->GetHash() != dealtGame->GetHash())
+		return false;
+
+	checkGame = game->Clone();
+	for (int i = int(currentMove); i < int(moveCount); i++)
+	{
+		if (!checkGame->CanApplyMove(moveArray[i]))
+			return false;
+
+		checkGame->ApplyMove(moveArray[i]);
+	}
+
+	this->EndRecording();
+	if (this->game.get())
+		this->game->SetMoveListener(nullptr);
+
+	this->game = game;
+	this->history.Restore(this->game.get(), moveArray, int(currentMove));
+
+	// A record starts from the deal, so recording picks up again with the next game.
+	return true;
+}
+
+void GameController::BeginRecording()
+{
+	// A record starts from the deal, so a game already under way when the writer is given goes unrecorded.
+	if (this->gameRecordWriter && this->game.get() && this->history.GetMoveCount() == 0)
+		this->gameRecordWriter->BeginGame(this->game.get());
+}
+
+void GameController::EndRecording()
+{
+	if (this->gameRecordWriter)
+		this->gameRecordWriter->EndGame();
+}
+
+SolitaireGame* GameController::GetGame() const
+{
+	return this->game.get();
+}
+
+const GameHistory& GameController::GetHistory() const
+{
+	return this->history;
+}
+
+bool GameController::OnMouseGrab(const Vector2D& worldPoint)
+{
+	if (!this->game.get())
+		return false;
+
+	return this->game->OnMouseGrabAt(worldPoint);
+}
+
+void GameController::OnMouseRelease(const Vector2D& worldPoint)
+{
+	// The game reports any move this makes to the history.
+	if (this->game.get())
+		this->game->OnMouseReleaseAt(worldPoint);
+}
+
+void GameController::OnMouseMove(const Vector2D& worldPoint)
+{
+	if (this->game.get())
+		this->game->OnMouseMove(worldPoint);
+}
+
+void GameController::OnKeyUp(uint32_t keyCode)
+{
+	if (this->game.get())
+		this->game->OnKeyUp(keyCode);
+}
+
+bool GameController::OnCardsNeeded(double timeSeconds)
+{
+	if (!this->game.get())
+		return false;
+
+	if (timeSeconds - this->lastCardsNeededTime <= MIN_TIME_BETWEEN_CARDS_NEEDED)
+		return false;
+
+	this->lastCardsNeededTime = timeSeconds;
+
+	// The history is a log of moves, so cards in hand must go back before any other move is made.
+	this->game->CancelCardMoving();
+	return this->game->OnCardsNeeded();
+}
+
+bool GameController::Undo()
+{
+	if (!this->game.get())
+		return false;
+
+	this->game->CancelCardMoving();
+	return this->history.Undo(this->game.get());
+}
+
+bool GameController::Redo()
+{
+	if (!this->game.get())
+		return false;
+
+	this->game->CancelCardMoving();
+	return this->history.Redo(this->game.get());
+}
+
+void GameController::Tick(double deltaTimeSeconds)
+{
+	if (this->game.get())
+		this->game->Tick(deltaTimeSeconds);
+}
\ No newline at end of file
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "SolitaireGame.h"
+#include "GameHistory.h"
+#include "GameRecord.h"
+
+#define MIN_TIME_BETWEEN_CARDS_NEEDED	0.5
+#define SAVED_GAME_MAGIC				"SOLS"
+#define SAVED_GAME_MAGIC_SIZE			4
+#define SAVED_GAME_VERSION				1
+
+// This is everything between an input event, given in world coordinates, and the game
+// and its undo history.  The application window feeds it from its Win32 messages and
+// the replay tool from a script, so that both drive the game in exactly the same way.
+class GameController
+{
+public:
+	GameController();
+	virtual ~GameController();
+
+	// This makes the given game the one being played, as it is now being move zero of its history.
+	void SetGame(std::shared_ptr<SolitaireGame> game);
+	void NewGame();
+	void NewGame(uint64_t seed);
+	void Clear();
+
+	// Once given a writer, every game played from then on is recorded to it, a game
+	// ending when another is started or the controller is cleared.
+	void SetGameRecordWriter(GameRecordWriter* gameRecordWriter);
+
+	// A saved game holds the deal, the cards as they are now and the undo history as a log of
+	// moves, so resuming it costs the same however long the game had gone on for.  A game that
+	// can't be resumed, being of a newer version or damaged, leaves the controller as it was.
+	// Cards in hand aren't in any pile, so saving puts them back first.
+	bool SaveGame(const std::string& filePath);
+	bool ResumeGame(const std::string& filePath, const Box& worldExtents, const Box& cardSize);
+
+	SolitaireGame* GetGame() const;
+	const GameHistory& GetHistory() const;
+
+	// If this returns true, cards are in hand and the mouse should stay captured until they're released.
+	bool OnMouseGrab(const Vector2D& worldPoint);
+	void OnMouseRelease(const Vector2D& worldPoint);
+	void OnMouseMove(const Vector2D& worldPoint);
+	void OnKeyUp(uint32_t keyCode);
+
+	// The time is in seconds since any fixed point.  A request too soon after the last one
+	// is ignored, as it's far more likely a double-click or a faulty mouse button than not.
+	// This, Undo() and Redo() put any cards in hand back first, as a release would find them gone.
+	bool OnCardsNeeded(double timeSeconds);
+
+	bool Undo();
+	bool Redo();
+	void Tick(double deltaTimeSeconds);
+
+private:
+	void BeginRecording();
+	void EndRecording();
+
+	std::shared_ptr<SolitaireGame> game;
+	GameHistory history;
+	double lastCardsNeededTime;
+	GameRecordWriter* gameRecordWriter;
+};
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "GameHistory.h"
+#include <assert.h>
+#include <stdlib.h>
+
+GameHistory::GameHistory()
+{
+	this->currentMove = 0;
+	this->moveListener = nullptr;
+}
+
+/*virtual*/ GameHistory::~GameHistory()
+{
+}
+
+void GameHistory::Reset(SolitaireGame* game)
+{
+	this->Clear();
+
+	game->SetMoveListener(this);
+
+	this->keyframeArray.push_back(Keyframe{ 0, game->Clone() });
+}
+
+void GameHistory::Restore(SolitaireGame* game, const std::vector<SolitaireGame::Move>& moveArray, int currentMove)
+{
+	assert(0 <= currentMove && currentMove <= int(moveArray.size()));
+
+	this->Clear();
+
+	game->SetMoveListener(this);
+
+	this->moveArray = moveArray;
+	this->currentMove = currentMove;
+
+	// Undoing past this steps back a move at a time, which is all the keyframes before it would have saved.
+	this->keyframeArray.push_back(Keyframe{ currentMove, game->Clone() });
+}
+
+void GameHistory::Clear()
+{
+	this->moveArray.clear();
+	this->keyframeArray.clear();
+	this->currentMove = 0;
+}
+
+bool GameHistory::CanUndo() const
+{
+	return this->currentMove > 0;
+}
+
+bool GameHistory::CanRedo() const
+{
+	return this->currentMove < int(this->moveArray.size());
+}
+
+bool GameHistory::Undo(SolitaireGame* game)
+{
+	if (!this->CanUndo())
+		return false;
+
+	// Moves the game made on its own get taken back along with the move that caused them.
+	while (this->currentMove > 0)
+	{
+		const SolitaireGame::Move& move = this->moveArray[--this->currentMove];
+		game->UndoMove(move);
+		if (this->moveListener)
+			this->moveListener->OnMoveUndone(game, move);
+		if ((move.flags & SolitaireGame::Move::Flags::AUTOMATIC) == 0)
+			break;
+	}
+
+	return true;
+}
+
+bool GameHistory::Redo(SolitaireGame* game)
+{
+	if (!this->CanRedo())
+		return false;
+
+	do
+	{
+		const SolitaireGame::Move& move = this->moveArray[this->currentMove++];
+		game->ApplyMove(move);
+		if (this->moveListener)
+			this->moveListener->OnMoveCommitted(game, move);
+	} while (this->currentMove < int(this->moveArray.size()) && (this->moveArray[this->currentMove].flags & SolitaireGame::Move::Flags::AUTOMATIC) != 0);
+
+	return true;
+}
+
+std::shared_ptr<SolitaireGame> GameHistory::JumpTo(std::shared_ptr<SolitaireGame> game, int moveNumber)
+{
+	assert(0 <= moveNumber && moveNumber <= int(this->moveArray.size()));
+
+	// Never stop between a move and the moves the game made on its own because of it.
+	while (moveNumber < int(this->moveArray.size()) && (this->moveArray[moveNumber].flags & SolitaireGame::Move::Flags::AUTOMATIC) != 0)
+		moveNumber++;
+
+	// Restart from the nearest snapshot only if that's less work than stepping there from here.
+	const Keyframe* keyframe = this->FindKeyframe(moveNumber);
+	if (keyframe && moveNumber - keyframe->moveNumber < ::abs(moveNumber - this->currentMove))
+	{
+		// The listener still hears of every move taken back, even though none are actually stepped through.
+		if (this->moveListener)
+			while (this->currentMove > keyframe->moveNumber)
+				this->moveListener->OnMoveUndone(game.get(), this->moveArray[--this->currentMove]);
+
+		game = keyframe->game->Clone();
+		game->SetMoveListener(this);
+		this->currentMove = keyframe->moveNumber;
+	}
+
+	while (this->currentMove > moveNumber)
+	{
+		game->UndoMove(this->moveArray[--this->currentMove]);
+		if (this->moveListener)
+			this->moveListener->OnMoveUndone(game.get(), this->moveArray[this->currentMove]);
+	}
+
+	while (this->currentMove < moveNumber)
+	{
+		game->ApplyMove(this->moveArray[this->currentMove++]);
+		if (this->moveListener)
+			this->moveListener->OnMoveCommitted(game.get(), this->moveArray[this->currentMove - 1]);
+	}
+
+	return game;
+}
+
+const GameHistory::Keyframe* GameHistory::FindKeyframe(int moveNumber) const
+{
+	// The keyframes are in move order.
+	for (int i = int(this->keyframeArray.size()) - 1; i >= 0; i--)
+		if (this->keyframeArray[i].moveNumber <= moveNumber)
+			return &this->keyframeArray[i];
+
+	return nullptr;
+}
+
+void GameHistory::SetMoveListener(SolitaireGame::MoveListener* moveListener)
+{
+	this->moveListener = moveListener;
+}
+
+int GameHistory::GetCurrentMove() const
+{
+	return this->currentMove;
+}
+
+int GameHistory::GetMoveCount() const
+{
+	return int(this->moveArray.size());
+}
+
+const std::vector<SolitaireGame::Move>& GameHistory::GetMoveArray() const
+{
+	return this->moveArray;
+}
+
+/*virtual*/ void GameHistory::OnMoveCommitted(SolitaireGame* game, const SolitaireGame::Move& move)
+{
+	// A new move forks the history, so anything that could have been redone is gone.
+	this->moveArray.resize(this->currentMove);
+	while (this->keyframeArray.size() > 0 && this->keyframeArray.back().moveNumber > this->currentMove)
+		this->keyframeArray.pop_back();
+
+	this->moveArray.push_back(move);
+	this->currentMove++;
+
+	// Snapshots share all unchanged piles with the game, so these are cheap to keep.
+	if (this->currentMove % HISTORY_KEYFRAME_INTERVAL == 0)
+		this->keyframeArray.push_back(Keyframe{ this->currentMove, game->Clone() });
+
+	if (this->moveListener)
+		this->moveListener->OnMoveCommitted(game, move);
+}
\ No newline at end of file
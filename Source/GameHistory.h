@@ -0,0 +1,56 @@
+#pragma once
+
+#include "SolitaireGame.h"
+
+#define HISTORY_KEYFRAME_INTERVAL		32
+
+// This is the undo/redo history of a game kept as a log of the moves made in it.
+// Stepping back or forward costs only as much as the cards a move touched.  Every
+// so many moves a snapshot of the game is kept as well, so that jumping anywhere
+// in the history never has to replay more than that many moves.
+class GameHistory : public SolitaireGame::MoveListener
+{
+public:
+	GameHistory();
+	virtual ~GameHistory();
+
+	void Reset(SolitaireGame* game);
+
+	// This takes up a history saved from GetMoveArray() and GetCurrentMove(), the given game
+	// being at the current move.  Nothing is replayed, so it costs the same however long the
+	// history is, but the only snapshot kept is of the current move until more are made.
+	void Restore(SolitaireGame* game, const std::vector<SolitaireGame::Move>& moveArray, int currentMove);
+	void Clear();
+
+	bool CanUndo() const;
+	bool CanRedo() const;
+	bool Undo(SolitaireGame* game);
+	bool Redo(SolitaireGame* game);
+
+	// The returned game is the one now at the given move; it may or may not be the given game.
+	std::shared_ptr<SolitaireGame> JumpTo(std::shared_ptr<SolitaireGame> game, int moveNumber);
+
+	// Every move committed, undone or redone is passed on to this listener, if there is one,
+	// so that it always sees the line of play that the history is currently on.
+	void SetMoveListener(SolitaireGame::MoveListener* moveListener);
+
+	int GetCurrentMove() const;
+	int GetMoveCount() const;
+	const std::vector<SolitaireGame::Move>& GetMoveArray() const;
+
+	virtual void OnMoveCommitted(SolitaireGame* game, const SolitaireGame::Move& move) override;
+
+private:
+	struct Keyframe
+	{
+		int moveNumber;
+		std::shared_ptr<SolitaireGame> game;
+	};
+
+	const Keyframe* FindKeyframe(int moveNumber) const;
+
+	std::vector<SolitaireGame::Move> moveArray;
+	std::vector<Keyframe> keyframeArray;
+	int currentMove;
+	SolitaireGame::MoveListener* moveListener;
+};
\ No newline at end of file
@@ -0,0 +1,331 @@
+#include "GameRecord.h"
+#include "SolitaireGames/KlondikeSolitaireGame.h"
+#include "SolitaireGames/FreeCellSolitaireGame.h"
+#include "SolitaireGames/SpiderSolitaireGame.h"
+#include <assert.h>
+#include <string.h>
+
+//----------------------------------- GameRecord -----------------------------------
+
+/*static*/ bool GameRecord::DescribeGame(const SolitaireGame* game, Header& header)
+{
+	header.difficultyLevel = 0;
+	header.seed = game->GetSeed();
+
+	if (dynamic_cast<const KlondikeSolitaireGame*>(game))
+		header.variant = Variant::KLONDIKE;
+	else if (dynamic_cast<const FreeCellSolitaireGame*>(game))
+		header.variant = Variant::FREECELL;
+	else if (const SpiderSolitaireGame* spiderGame = dynamic_cast<const SpiderSolitaireGame*>(game))
+	{
+		header.variant = Variant::SPIDER;
+		header.difficultyLevel = int(spiderGame->GetDifficultyLevel());
+	}
+	else
+		return false;
+
+	return true;
+}
+
+/*static*/ std::shared_ptr<SolitaireGame> GameRecord::CreateGame(const Header& header, const Box& worldExtents, const Box& cardSize)
+{
+	switch (header.variant)
+	{
+	case Variant::KLONDIKE:
+		return std::make_shared<KlondikeSolitaireGame>(worldExtents, cardSize);
+	case Variant::FREECELL:
+		return std::make_shared<FreeCellSolitaireGame>(worldExtents, cardSize);
+	case Variant::SPIDER:
+		if (header.difficultyLevel < SpiderSolitaireGame::DifficultyLevel::LOW || header.difficultyLevel > SpiderSolitaireGame::DifficultyLevel::HARD)
+			return nullptr;
+		return std::make_shared<SpiderSolitaireGame>(worldExtents, cardSize, SpiderSolitaireGame::DifficultyLevel(header.difficultyLevel));
+	default:
+		return nullptr;
+	}
+}
+
+/*static*/ uint32_t GameRecord::EncodeMove(const SolitaireGame::Move& move)
+{
+	assert(move.sourcePile < (1 << PILE_BITS) && move.targetPile < (1 << PILE_BITS));
+	assert(move.type != SolitaireGame::Move::Type::MOVE_CARDS || move.cardCount > 0);
+
+	return uint32_t(move.sourcePile) |
+		(uint32_t(move.targetPile) << TARGET_PILE_SHIFT) |
+		(uint32_t(move.type) << TYPE_SHIFT) |
+		(uint32_t(move.flags) << FLAGS_SHIFT) |
+		(uint32_t(move.cardCount) << CARD_COUNT_SHIFT);
+}
+
+/*static*/ bool GameRecord::DecodeMove(uint32_t value, SolitaireGame::Move& move)
+{
+	uint32_t pileMask = (1 << PILE_BITS) - 1;
+	uint32_t cardCount = value >> CARD_COUNT_SHIFT;
+	uint32_t type = (value >> TYPE_SHIFT) & 0x3;
+
+	if (cardCount > 0xFF || type > SolitaireGame::Move::Type::REMOVE_CARDS)
+		return false;
+
+	if (type == SolitaireGame::Move::Type::MOVE_CARDS && cardCount == 0)
+		return false;
+
+	move = SolitaireGame::Move(SolitaireGame::Move::Type(type),
+		int(value & pileMask),
+		int((value >> TARGET_PILE_SHIFT) & pileMask),
+		int(cardCount),
+		uint8_t((value >> FLAGS_SHIFT) & 0x7));
+
+	return true;
+}
+
+/*static*/ void GameRecord::WriteVarint(uint64_t value, std::vector<uint8_t>& byteArray)
+{
+	// Seven bits a byte, least significant first, the top bit set on all but the last.
+	while (value >= 0x80)
+	{
+		byteArray.push_back(uint8_t(value | 0x80));
+		value >>= 7;
+	}
+
+	byteArray.push_back(uint8_t(value));
+}
+
+/*static*/ bool GameRecord::ReadVarint(const uint8_t*& data, const uint8_t* dataEnd, uint64_t& value)
+{
+	value = 0;
+
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (data >= dataEnd)
+			return false;
+
+		uint8_t byte = *data++;
+		value |= uint64_t(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+//----------------------------------- GameRecordWriter -----------------------------------
+
+GameRecordWriter::GameRecordWriter()
+{
+	this->gameBegun = false;
+}
+
+/*virtual*/ GameRecordWriter::~GameRecordWriter()
+{
+	this->Close();
+}
+
+bool GameRecordWriter::Open(const std::string& filePath)
+{
+	this->Close();
+
+	// Only add to a file that's already a record of this version.
+	std::vector<uint8_t> headerArray(GAME_RECORD_MAGIC, GAME_RECORD_MAGIC + GAME_RECORD_MAGIC_SIZE);
+	GameRecord::WriteVarint(GAME_RECORD_VERSION, headerArray);
+
+	std::ifstream existingStream(filePath, std::ios::in | std::ios::binary);
+	if (existingStream.is_open())
+	{
+		std::vector<uint8_t> existingArray(headerArray.size());
+		existingStream.read((char*)existingArray.data(), existingArray.size());
+		if (existingStream.gcount() > 0 && (size_t(existingStream.gcount()) != existingArray.size() || existingArray != headerArray))
+			return false;
+
+		if (existingStream.gcount() > 0)
+			headerArray.clear();
+	}
+
+	this->fileStream.open(filePath, std::ios::out | std::ios::binary | std::ios::app);
+	if (!this->fileStream.is_open())
+		return false;
+
+	this->fileStream.write((const char*)headerArray.data(), headerArray.size());
+	return this->fileStream.good();
+}
+
+void GameRecordWriter::Close()
+{
+	if (this->fileStream.is_open())
+	{
+		this->EndGame();
+		this->fileStream.close();
+	}
+}
+
+bool GameRecordWriter::IsOpen() const
+{
+	return this->fileStream.is_open();
+}
+
+bool GameRecordWriter::BeginGame(const SolitaireGame* game)
+{
+	this->EndGame();
+
+	GameRecord::Header header;
+	if (!this->fileStream.is_open() || !GameRecord::DescribeGame(game, header))
+		return false;
+
+	this->WriteValue(uint64_t(header.variant));
+	this->WriteValue(uint64_t(header.difficultyLevel));
+	this->WriteValue(header.seed);
+	this->gameBegun = true;
+	return true;
+}
+
+void GameRecordWriter::EndGame()
+{
+	if (!this->gameBegun)
+		return;
+
+	this->WriteValue(GameRecord::END_OF_GAME);
+	this->fileStream.flush();
+	this->gameBegun = false;
+}
+
+/*virtual*/ void GameRecordWriter::OnMoveCommitted(SolitaireGame* /*game*/, const SolitaireGame::Move& move)
+{
+	if (this->gameBegun)
+		this->WriteValue(GameRecord::EncodeMove(move));
+}
+
+/*virtual*/ void GameRecordWriter::OnMoveUndone(SolitaireGame* /*game*/, const SolitaireGame::Move& /*move*/)
+{
+	if (this->gameBegun)
+		this->WriteValue(GameRecord::UNDO_MOVE);
+}
+
+void GameRecordWriter::WriteValue(uint64_t value)
+{
+	this->byteArray.clear();
+	GameRecord::WriteVarint(value, this->byteArray);
+	this->fileStream.write((const char*)this->byteArray.data(), this->byteArray.size());
+}
+
+//----------------------------------- GameRecordReader -----------------------------------
+
+GameRecordReader::GameRecordReader()
+{
+	this->dataEnd = nullptr;
+	this->firstGame = nullptr;
+	this->nextGame = nullptr;
+}
+
+/*virtual*/ GameRecordReader::~GameRecordReader()
+{
+}
+
+bool GameRecordReader::SetData(const uint8_t* data, size_t dataSize)
+{
+	this->dataEnd = nullptr;
+	this->firstGame = nullptr;
+	this->nextGame = nullptr;
+
+	if (dataSize < GAME_RECORD_MAGIC_SIZE || ::memcmp(data, GAME_RECORD_MAGIC, GAME_RECORD_MAGIC_SIZE) != 0)
+		return false;
+
+	const uint8_t* cursor = data + GAME_RECORD_MAGIC_SIZE;
+	uint64_t version = 0;
+	if (!GameRecord::ReadVarint(cursor, data + dataSize, version) || version != GAME_RECORD_VERSION)
+		return false;
+
+	this->dataEnd = data + dataSize;
+	this->firstGame = cursor;
+	this->nextGame = cursor;
+	return true;
+}
+
+bool GameRecordReader::NextGame(GameRecord::Header& header, std::vector<SolitaireGame::Move>& moveArray)
+{
+	moveArray.clear();
+
+	if (!this->nextGame || this->nextGame >= this->dataEnd)
+		return false;
+
+	const uint8_t* cursor = this->nextGame;
+	uint64_t variant = 0, difficultyLevel = 0, seed = 0;
+	if (!GameRecord::ReadVarint(cursor, this->dataEnd, variant) ||
+		!GameRecord::ReadVarint(cursor, this->dataEnd, difficultyLevel) ||
+		!GameRecord::ReadVarint(cursor, this->dataEnd, seed) ||
+		variant >= GameRecord::Variant::NUM_VARIANTS)
+	{
+		this->nextGame = this->dataEnd;
+		return false;
+	}
+
+	header.variant = GameRecord::Variant(variant);
+	header.difficultyLevel = int(difficultyLevel);
+	header.seed = seed;
+
+	uint64_t value = 0;
+	while (GameRecord::ReadVarint(cursor, this->dataEnd, value) && value != GameRecord::END_OF_GAME)
+	{
+		if (value == GameRecord::UNDO_MOVE)
+		{
+			if (moveArray.size() > 0)
+				moveArray.pop_back();
+			continue;
+		}
+
+		SolitaireGame::Move move;
+		if (value > UINT32_MAX || !GameRecord::DecodeMove(uint32_t(value), move))
+		{
+			// Nothing after a corrupt value can be trusted.
+			this->nextGame = this->dataEnd;
+			return false;
+		}
+
+		moveArray.push_back(move);
+	}
+
+	this->nextGame = cursor;
+	return true;
+}
+
+void GameRecordReader::Rewind()
+{
+	this->nextGame = this->firstGame;
+}
+
+/*static*/ std::shared_ptr<SolitaireGame> GameRecordReader::Reconstruct(const GameRecord::Header& header, const std::vector<SolitaireGame::Move>& moveArray, int moveNumber, const Box& worldExtents, const Box& cardSize)
+{
+	assert(0 <= moveNumber && moveNumber <= int(moveArray.size()));
+
+	std::shared_ptr<SolitaireGame> game = GameRecord::CreateGame(header, worldExtents, cardSize);
+	if (!game.get())
+		return nullptr;
+
+	game->NewGame(header.seed);
+
+	// The moves come from a file, so each is checked before it's made.
+	for (int i = 0; i < moveNumber; i++)
+	{
+		if (!game->CanApplyMove(moveArray[i]))
+			return nullptr;
+
+		game->ApplyMove(moveArray[i]);
+	}
+
+	return game;
+}
+
+/*static*/ bool GameRecordReader::LoadFile(const std::string& filePath, std::vector<uint8_t>& byteArray)
+{
+	byteArray.clear();
+
+	std::ifstream fileStream(filePath, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!fileStream.is_open())
+		return false;
+
+	std::streamoff fileSize = fileStream.tellg();
+	if (fileSize < 0)
+		return false;
+
+	byteArray.resize(size_t(fileSize));
+	fileStream.seekg(0);
+	fileStream.read((char*)byteArray.data(), fileSize);
+	return fileStream.good();
+}
\ No newline at end of file
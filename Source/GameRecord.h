@@ -0,0 +1,120 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <memory>
+#include <stdint.h>
+#include "SolitaireGame.h"
+
+#define GAME_RECORD_MAGIC			"SOLR"
+#define GAME_RECORD_MAGIC_SIZE		4
+#define GAME_RECORD_VERSION			1
+
+// A game record file holds any number of played games back to back, each taking just
+// a few bytes per move, so that millions of them fit in a file small enough to map
+// into memory whole.  The file starts with the magic bytes and a version number.
+// Each game is then the variant, the difficulty level and the seed of its deal,
+// followed by its moves, every number being an unsigned LEB128 varint.  A move is
+// packed into a single number, most moves fitting in two bytes, and the game ends
+// with a zero.  A move taken back is recorded as a marker rather than erased, so
+// a game can be written out as it's played without ever seeking back.
+class GameRecord
+{
+public:
+	enum Variant
+	{
+		KLONDIKE,
+		FREECELL,
+		SPIDER,
+		NUM_VARIANTS
+	};
+
+	struct Header
+	{
+		Variant variant;
+		int difficultyLevel;
+		uint64_t seed;
+	};
+
+	// Bits 0-3 hold the source pile, bits 4-7 the target pile, bits 8-9 the move type,
+	// bits 10-12 the flags and the rest the card count.  No real move of cards has a
+	// card count of zero, so those values are free to mark the end of a game and an undo.
+	enum : uint32_t
+	{
+		END_OF_GAME = 0,
+		UNDO_MOVE = 1,
+		PILE_BITS = 4,
+		TARGET_PILE_SHIFT = 4,
+		TYPE_SHIFT = 8,
+		FLAGS_SHIFT = 10,
+		CARD_COUNT_SHIFT = 13
+	};
+
+	// This fails for games of a kind that can't be recorded.
+	static bool DescribeGame(const SolitaireGame* game, Header& header);
+	static std::shared_ptr<SolitaireGame> CreateGame(const Header& header, const Box& worldExtents, const Box& cardSize);
+
+	static uint32_t EncodeMove(const SolitaireGame::Move& move);
+	static bool DecodeMove(uint32_t value, SolitaireGame::Move& move);
+
+	static void WriteVarint(uint64_t value, std::vector<uint8_t>& byteArray);
+	static bool ReadVarint(const uint8_t*& data, const uint8_t* dataEnd, uint64_t& value);
+};
+
+// This writes each game it's told to begin to a record file as the game is played.
+// Hooked up to a game's undo history, it hears of every move made, taken back or made
+// again, and the move is out in the file's buffer before the next one is made.
+class GameRecordWriter : public SolitaireGame::MoveListener
+{
+public:
+	GameRecordWriter();
+	virtual ~GameRecordWriter();
+
+	// Games are added to the end of any record file already there.
+	bool Open(const std::string& filePath);
+	void Close();
+	bool IsOpen() const;
+
+	bool BeginGame(const SolitaireGame* game);
+	void EndGame();
+
+	virtual void OnMoveCommitted(SolitaireGame* game, const SolitaireGame::Move& move) override;
+	virtual void OnMoveUndone(SolitaireGame* game, const SolitaireGame::Move& move) override;
+
+private:
+	void WriteValue(uint64_t value);
+
+	std::ofstream fileStream;
+	std::vector<uint8_t> byteArray;
+	bool gameBegun;
+};
+
+// This reads the games out of a record, which it doesn't own and never copies, so the
+// record may just as well be a file mapped into memory as one loaded into a buffer.
+class GameRecordReader
+{
+public:
+	GameRecordReader();
+	virtual ~GameRecordReader();
+
+	// This fails if the data isn't a record of a version this can read.
+	bool SetData(const uint8_t* data, size_t dataSize);
+
+	// The moves returned are the game's line of play as it stood when the game ended, with any
+	// moves that were taken back left out.  The last game is returned even if it never ended,
+	// as happens if whatever was writing it stopped without warning.
+	bool NextGame(GameRecord::Header& header, std::vector<SolitaireGame::Move>& moveArray);
+	void Rewind();
+
+	// This deals the game again and plays it up to the given move.  If any move
+	// along the way can't be made, the record is damaged and nothing is returned.
+	static std::shared_ptr<SolitaireGame> Reconstruct(const GameRecord::Header& header, const std::vector<SolitaireGame::Move>& moveArray, int moveNumber, const Box& worldExtents, const Box& cardSize);
+
+	static bool LoadFile(const std::string& filePath, std::vector<uint8_t>& byteArray);
+
+private:
+	const uint8_t* dataEnd;
+	const uint8_t* firstGame;
+	const uint8_t* nextGame;
+};
\ No newline at end of file
@@ -0,0 +1,114 @@
+#include "InputScript.h"
+#include <fstream>
+#include <sstream>
+
+InputScript::InputScript()
+{
+	this->seed = 0;
+}
+
+/*virtual*/ InputScript::~InputScript()
+{
+}
+
+/*static*/ const char* InputScript::GetEventName(Event::Type type)
+{
+	switch (type)
+	{
+	case Event::Type::MOUSE_GRAB:
+		return "grab";
+	case Event::Type::MOUSE_MOVE:
+		return "move";
+	case Event::Type::MOUSE_RELEASE:
+		return "release";
+	case Event::Type::CARDS_NEEDED:
+		return "cards";
+	case Event::Type::UNDO:
+		return "undo";
+	case Event::Type::REDO:
+		return "redo";
+	default:
+		return "";
+	}
+}
+
+void InputScript::Clear()
+{
+	this->variantName.clear();
+	this->seed = 0;
+	this->eventArray.clear();
+}
+
+void InputScript::AddEvent(Event::Type type, double timeSeconds, const Vector2D& worldPoint /*= Vector2D(0.0f, 0.0f)*/)
+{
+	this->eventArray.push_back(Event{ type, timeSeconds, worldPoint });
+}
+
+bool InputScript::Load(const std::string& filePath)
+{
+	this->Clear();
+
+	std::ifstream fileStream(filePath);
+	if (!fileStream.is_open())
+		return false;
+
+	// The first line says which game was played.
+	std::string line;
+	if (!std::getline(fileStream, line))
+		return false;
+
+	std::istringstream headerStream(line);
+	if (!(headerStream >> this->variantName >> this->seed))
+		return false;
+
+	while (std::getline(fileStream, line))
+	{
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		std::istringstream lineStream(line);
+		double timeSeconds = 0.0;
+		std::string eventName;
+		if (!(lineStream >> timeSeconds >> eventName))
+			return false;
+
+		int i = 0;
+		while (i < Event::Type::NUM_TYPES && eventName != GetEventName(Event::Type(i)))
+			i++;
+
+		if (i == Event::Type::NUM_TYPES)
+			return false;
+
+		Vector2D worldPoint(0.0f, 0.0f);
+		if (i == Event::Type::MOUSE_GRAB || i == Event::Type::MOUSE_MOVE || i == Event::Type::MOUSE_RELEASE)
+		{
+			if (!(lineStream >> worldPoint.x >> worldPoint.y))
+				return false;
+		}
+
+		this->AddEvent(Event::Type(i), timeSeconds, worldPoint);
+	}
+
+	return true;
+}
+
+bool InputScript::Save(const std::string& filePath) const
+{
+	std::ofstream fileStream(filePath, std::ios::out | std::ios::trunc);
+	if (!fileStream.is_open())
+		return false;
+
+	// Enough digits that the points read back exactly.
+	fileStream.precision(9);
+	fileStream << this->variantName << " " << this->seed << "\n";
+
+	for (const Event& event : this->eventArray)
+	{
+		fileStream << event.timeSeconds << " " << GetEventName(event.type);
+		if (event.type == Event::Type::MOUSE_GRAB || event.type == Event::Type::MOUSE_MOVE || event.type == Event::Type::MOUSE_RELEASE)
+			fileStream << " " << event.worldPoint.x << " " << event.worldPoint.y;
+		fileStream << "\n";
+	}
+
+	return fileStream.good();
+}
\ No newline at end of file
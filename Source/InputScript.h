@@ -0,0 +1,46 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+#include "Vector2D.h"
+
+// This is a recording of the input given to a game, in world coordinates, along with
+// what it takes to deal the same game again.  It's saved as text, one event a line,
+// each line giving the time of the event in seconds, its name, then any point.
+class InputScript
+{
+public:
+	InputScript();
+	virtual ~InputScript();
+
+	struct Event
+	{
+		enum Type : uint8_t
+		{
+			MOUSE_GRAB,
+			MOUSE_MOVE,
+			MOUSE_RELEASE,
+			CARDS_NEEDED,
+			UNDO,
+			REDO,
+			NUM_TYPES
+		};
+
+		Type type;
+		double timeSeconds;
+		Vector2D worldPoint;
+	};
+
+	static const char* GetEventName(Event::Type type);
+
+	void Clear();
+	void AddEvent(Event::Type type, double timeSeconds, const Vector2D& worldPoint = Vector2D(0.0f, 0.0f));
+
+	bool Load(const std::string& filePath);
+	bool Save(const std::string& filePath) const;
+
+	std::string variantName;
+	uint64_t seed;
+	std::vector<Event> eventArray;
+};
\ No newline at end of file
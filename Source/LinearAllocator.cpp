@@ -0,0 +1,80 @@
+#include "LinearAllocator.h"
+#include <assert.h>
+
+LinearAllocator::LinearAllocator(uint64_t pageSize)
+{
+	assert(pageSize > 0);
+
+	this->pageSizeArray.push_back(pageSize);
+	this->currentPage = 0;
+	this->currentOffset = 0;
+	this->usedSize = 0;
+}
+
+/*virtual*/ LinearAllocator::~LinearAllocator()
+{
+}
+
+bool LinearAllocator::Reset()
+{
+	bool pagesReplaced = false;
+
+	if (this->pageSizeArray.size() > 1)
+	{
+		uint64_t totalSize = 0;
+		for (uint64_t pageSize : this->pageSizeArray)
+			totalSize += pageSize;
+
+		this->pageSizeArray.clear();
+		this->pageSizeArray.push_back(totalSize);
+		pagesReplaced = true;
+	}
+
+	this->currentPage = 0;
+	this->currentOffset = 0;
+	this->usedSize = 0;
+
+	return pagesReplaced;
+}
+
+LinearAllocator::Allocation LinearAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	assert(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	uint64_t offset = (this->currentOffset + alignment - 1) & ~(alignment - 1);
+	if (offset + size > this->pageSizeArray[this->currentPage])
+	{
+		// What's left of this page is given up.  The next page is big enough for
+		// the allocation at any alignment, since pages start at offset zero.
+		this->usedSize += this->pageSizeArray[this->currentPage] - this->currentOffset;
+
+		uint64_t pageSize = this->pageSizeArray[this->currentPage] * 2;
+		while (pageSize < size)
+			pageSize *= 2;
+
+		this->pageSizeArray.push_back(pageSize);
+		this->currentPage++;
+		this->currentOffset = 0;
+		offset = 0;
+	}
+
+	this->usedSize += offset + size - this->currentOffset;
+	this->currentOffset = offset + size;
+
+	return Allocation{ this->currentPage, offset };
+}
+
+int LinearAllocator::GetPageCount() const
+{
+	return int(this->pageSizeArray.size());
+}
+
+uint64_t LinearAllocator::GetPageSize(int page) const
+{
+	return this->pageSizeArray[page];
+}
+
+uint64_t LinearAllocator::GetUsedSize() const
+{
+	return this->usedSize;
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+// This hands out space from a chain of pages by just bumping an offset, and takes it
+// all back at once.  It only does the bookkeeping; whoever owns it provides the memory
+// behind each page, which is how the renderer uses it to carve up GPU upload buffers
+// a swap frame at a time.  Space is never moved once handed out, so when a page fills
+// up, allocation carries on in a new page at least twice as big.  A reset then swaps
+// all the pages for a single one big enough for everything, so a steady load settles
+// into one page that is never replaced again.
+class LinearAllocator
+{
+public:
+	LinearAllocator(uint64_t pageSize);
+	virtual ~LinearAllocator();
+
+	struct Allocation
+	{
+		int page;
+		uint64_t offset;
+	};
+
+	// This returns true if the pages were replaced, in which case all memory behind them can go.
+	bool Reset();
+
+	// The alignment must be a power of two.  The page is always one that exists once this returns.
+	Allocation Allocate(uint64_t size, uint64_t alignment);
+
+	int GetPageCount() const;
+	uint64_t GetPageSize(int page) const;
+
+	// This is everything handed out since the last reset, counting alignment padding and the unused ends of filled pages.
+	uint64_t GetUsedSize() const;
+
+private:
+	std::vector<uint64_t> pageSizeArray;
+	int currentPage;
+	uint64_t currentOffset;
+	uint64_t usedSize;
+};
\ No newline at end of file
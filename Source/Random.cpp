@@ -0,0 +1,77 @@
+#include "Random.h"
+#include <random>
+#include <chrono>
+
+Random::Random()
+{
+	this->SetSeed(0);
+}
+
+Random::Random(uint64_t seed)
+{
+	this->SetSeed(seed);
+}
+
+/*virtual*/ Random::~Random()
+{
+}
+
+void Random::SetSeed(uint64_t seed)
+{
+	this->seed = seed;
+
+	// Spread the seed over the whole state with splitmix64, which never leaves it all zero.
+	uint64_t mix = seed;
+	for (int i = 0; i < 4; i++)
+	{
+		mix += 0x9E3779B97F4A7C15ull;
+		uint64_t value = mix;
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+		this->state[i] = value ^ (value >> 31);
+	}
+}
+
+uint64_t Random::GetSeed() const
+{
+	return this->seed;
+}
+
+uint64_t Random::NextInteger()
+{
+	uint64_t result = this->state[1] * 5;
+	result = ((result << 7) | (result >> 57)) * 9;
+
+	uint64_t shifted = this->state[1] << 17;
+	this->state[2] ^= this->state[0];
+	this->state[3] ^= this->state[1];
+	this->state[1] ^= this->state[2];
+	this->state[0] ^= this->state[3];
+	this->state[2] ^= shifted;
+	this->state[3] = (this->state[3] << 45) | (this->state[3] >> 19);
+
+	return result;
+}
+
+int Random::IntegerInRange(int min, int max)
+{
+	// Scale a 32-bit sample up to the range with a multiply, then reject the few samples
+	// that would make some results more likely than others (Lemire's method.)
+	uint32_t range = uint32_t(max - min) + 1;
+	uint64_t product = (this->NextInteger() >> 32) * uint64_t(range);
+	if (uint32_t(product) < range)
+	{
+		uint32_t threshold = uint32_t(-range) % range;
+		while (uint32_t(product) < threshold)
+			product = (this->NextInteger() >> 32) * uint64_t(range);
+	}
+
+	return min + int(product >> 32);
+}
+
+/*static*/ uint64_t Random::MakeSeed()
+{
+	std::random_device device;
+	uint64_t seed = (uint64_t(device()) << 32) | uint64_t(device());
+	return seed ^ uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+}
\ No newline at end of file
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+
+// This is the xoshiro256** generator, seeded through splitmix64.  What it returns for
+// a given seed comes from fixed-width integer arithmetic alone, so a seed produces the
+// same sequence on every platform and compiler.  Each game owns one, so that games on
+// different threads share no state.
+class Random
+{
+public:
+	Random();
+	Random(uint64_t seed);
+	virtual ~Random();
+
+	void SetSeed(uint64_t seed);
+	uint64_t GetSeed() const;
+
+	uint64_t NextInteger();
+
+	// Every integer from min to max inclusive is returned with the same probability.
+	int IntegerInRange(int min, int max);
+
+	// This is a seed that is different every time it's called.
+	static uint64_t MakeSeed();
+
+private:
+	uint64_t seed;
+	uint64_t state[4];
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#include "RenderCommandList.h"
+
+// The shader steps through the instances 32 bytes at a time.
+static_assert(sizeof(RenderCommandList::CardInstance) == 32, "Card instance layout no longer matches the shader.");
+
+RenderCommandList::RenderCommandList()
+{
+}
+
+/*virtual*/ RenderCommandList::~RenderCommandList()
+{
+}
+
+void RenderCommandList::Reset()
+{
+	// The arrays keep their memory from one frame to the next.
+	this->instanceArray.clear();
+	this->commandArray.clear();
+}
+
+void RenderCommandList::RecordCards(const std::vector<SolitaireGame::RenderItem>& renderList, const Box& cardSize)
+{
+	uint32_t firstInstance = uint32_t(this->instanceArray.size());
+
+	for (const SolitaireGame::RenderItem& renderItem : renderList)
+	{
+		CardInstance instance{};
+		instance.position[0] = renderItem.position.x;
+		instance.position[1] = renderItem.position.y;
+		instance.size[0] = float(cardSize.GetWidth());
+		instance.size[1] = float(cardSize.GetHeight());
+		instance.textureIndex = uint32_t(renderItem.card.GetTextureIndex());
+		this->instanceArray.push_back(instance);
+	}
+
+	uint32_t instanceCount = uint32_t(this->instanceArray.size()) - firstInstance;
+	if (instanceCount == 0)
+		return;
+
+	Command command;
+	command.type = Command::Type::DRAW_INSTANCED;
+	command.vertexCount = CARD_VERTEX_COUNT;
+	command.instanceCount = instanceCount;
+	command.firstInstance = firstInstance;
+	this->commandArray.push_back(command);
+}
+
+const std::vector<RenderCommandList::CardInstance>& RenderCommandList::GetInstanceArray() const
+{
+	return this->instanceArray;
+}
+
+const std::vector<RenderCommandList::Command>& RenderCommandList::GetCommandArray() const
+{
+	return this->commandArray;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include "SolitaireGame.h"
+
+// A card is a quad drawn as two triangles.
+#define CARD_VERTEX_COUNT			6
+
+// This records what a frame draws without drawing it, so that the same batch of
+// cards can be handed to the GPU by the window or checked headless.  The cards are
+// gathered into an array of instances that the renderer copies straight into GPU
+// memory, along with the draw commands that consume them, in order.
+class RenderCommandList
+{
+public:
+	RenderCommandList();
+	virtual ~RenderCommandList();
+
+	// The card shader reads an array of these, so the layout here must match its structured buffer.
+	struct CardInstance
+	{
+		float position[2];			// This is the world-space lower-left corner of the card.
+		float size[2];				// This is the world-space width and height of the card.
+		uint32_t textureIndex;		// This is the slice of the card texture array the card is drawn from, as Card::GetTextureIndex() gives it.
+		uint32_t pad[3];			// Pad the instance to a multiple of 16 bytes so that none straddles a cache line.
+	};
+
+	struct Command
+	{
+		enum Type
+		{
+			DRAW_INSTANCED,
+			NUM_TYPES
+		};
+
+		Type type;
+		uint32_t vertexCount;
+		uint32_t instanceCount;
+		uint32_t firstInstance;
+	};
+
+	void Reset();
+
+	// This adds an instance for each card in the list, in order, and a single command to draw them all.
+	void RecordCards(const std::vector<SolitaireGame::RenderItem>& renderList, const Box& cardSize);
+
+	const std::vector<CardInstance>& GetInstanceArray() const;
+	const std::vector<Command>& GetCommandArray() const;
+
+private:
+	std::vector<CardInstance> instanceArray;
+	std::vector<Command> commandArray;
+};
\ No newline at end of file
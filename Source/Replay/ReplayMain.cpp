@@ -0,0 +1,431 @@
+#include "GameController.h"
+#include "InputScript.h"
+#include "GameRecord.h"
+#include "Clock.h"
+#include "RenderCommandList.h"
+#include "AllocationTracker.h"
+#include "SolitaireGames/KlondikeSolitaireGame.h"
+#include "SolitaireGames/FreeCellSolitaireGame.h"
+#include "SolitaireGames/SpiderSolitaireGame.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// The game is ticked between events a frame at a time, as the window would tick it.
+#define REPLAY_FRAME_TIME		(1.0 / 60.0)
+
+// These are how many frames the steady frame check lets pass before it starts counting
+// allocations, so that every reused array has grown to size, and how many it then counts.
+#define STEADY_FRAME_WARM_UP_COUNT		120
+#define STEADY_FRAME_COUNT				240
+
+// Usage: solitaire-replay <script file> [<record file>] [--expect <move number> <hash>]
+//        solitaire-replay --generate <variant> <seed> <move count> <script file>
+
+static std::shared_ptr<SolitaireGame> MakeGame(const std::string& variantName)
+{
+	// These are the world and card sizes that the application uses.
+	Box worldExtents = SolitaireGame::MakeWorldExtents();
+	Box cardSize = SolitaireGame::MakeCardSize();
+
+	if (variantName == "klondike")
+		return std::make_shared<KlondikeSolitaireGame>(worldExtents, cardSize);
+	if (variantName == "freecell")
+		return std::make_shared<FreeCellSolitaireGame>(worldExtents, cardSize);
+	if (variantName == "spider-low")
+		return std::make_shared<SpiderSolitaireGame>(worldExtents, cardSize, SpiderSolitaireGame::DifficultyLevel::LOW);
+	if (variantName == "spider-medium")
+		return std::make_shared<SpiderSolitaireGame>(worldExtents, cardSize, SpiderSolitaireGame::DifficultyLevel::MEDIUM);
+	if (variantName == "spider-hard")
+		return std::make_shared<SpiderSolitaireGame>(worldExtents, cardSize, SpiderSolitaireGame::DifficultyLevel::HARD);
+
+	return nullptr;
+}
+
+static void TickUntil(GameController& gameController, double& gameTime, double timeSeconds, std::vector<double>* latencyArray)
+{
+	Clock clock;
+	while (gameTime + REPLAY_FRAME_TIME <= timeSeconds)
+	{
+		clock.Reset();
+		gameController.Tick(REPLAY_FRAME_TIME);
+		if (latencyArray)
+			latencyArray->push_back(clock.GetCurrentTimeMilliseconds() * 1000.0);
+
+		gameTime += REPLAY_FRAME_TIME;
+	}
+}
+
+static void DispatchEvent(GameController& gameController, const InputScript::Event& event)
+{
+	switch (event.type)
+	{
+	case InputScript::Event::Type::MOUSE_GRAB:
+		gameController.OnMouseGrab(event.worldPoint);
+		break;
+	case InputScript::Event::Type::MOUSE_MOVE:
+		gameController.OnMouseMove(event.worldPoint);
+		break;
+	case InputScript::Event::Type::MOUSE_RELEASE:
+		gameController.OnMouseRelease(event.worldPoint);
+		break;
+	case InputScript::Event::Type::CARDS_NEEDED:
+		gameController.OnCardsNeeded(event.timeSeconds);
+		break;
+	case InputScript::Event::Type::UNDO:
+		gameController.Undo();
+		break;
+	case InputScript::Event::Type::REDO:
+		gameController.Redo();
+		break;
+	default:
+		break;
+	}
+}
+
+static void ReportLatencies(const char* name, std::vector<double>& latencyArray)
+{
+	if (latencyArray.size() == 0)
+		return;
+
+	std::sort(latencyArray.begin(), latencyArray.end());
+
+	auto percentile = [&latencyArray](double fraction) -> double {
+		return latencyArray[size_t(fraction * double(latencyArray.size() - 1) + 0.5)];
+	};
+
+	printf("%-8s %8d %10.2f %10.2f %10.2f %10.2f\n", name, int(latencyArray.size()),
+		percentile(0.5), percentile(0.9), percentile(0.99), latencyArray.back());
+}
+
+static Vector2D PointOnCard(const SolitaireGame::CardPile* cardPile, int cardOffset, const Box& cardSize)
+{
+	// Aim near the top of the card, which is the part of it left showing in a cascade.
+	Vector2D position = (cardOffset >= 0) ? cardPile->visualArray[cardOffset].position : cardPile->position;
+	return position + Vector2D(float(cardSize.GetWidth() * 0.5), float(cardSize.GetHeight() * 0.9));
+}
+
+// This does everything the window does for a frame short of talking to the GPU.
+static void RunFrame(GameController& gameController, std::vector<SolitaireGame::RenderItem>& renderList, RenderCommandList& renderCommandList, const Box& cardSize)
+{
+	gameController.Tick(REPLAY_FRAME_TIME);
+
+	renderList.clear();
+	gameController.GetGame()->GenerateRenderList(renderList);
+
+	renderCommandList.Reset();
+	renderCommandList.RecordCards(renderList, cardSize);
+}
+
+static bool ReportFrameAllocations(const char* name, const FrameAllocationReport& report)
+{
+	printf("%-8s %8d frames made %llu allocations, at most %llu in a frame.\n", name, report.GetFrameCount(),
+		(unsigned long long)report.GetAllocationCount(), (unsigned long long)report.GetMaxFrameAllocationCount());
+	return report.GetAllocationCount() == 0;
+}
+
+// Once the arrays a frame reuses have grown to size, neither an idle frame nor a frame
+// spent dragging cards should touch the heap.  This fails if either does.
+static bool CheckSteadyFrames(GameController& gameController, const Box& cardSize)
+{
+	// This is built in with AllocationCounting.cpp, so this only happens if that's been lost.
+	if (!AllocationTracker::IsCounting())
+	{
+		fprintf(stderr, "Allocations aren't being counted, so steady frames can't be checked.\n");
+		return false;
+	}
+
+	std::vector<SolitaireGame::RenderItem> renderList;
+	RenderCommandList renderCommandList;
+	FrameAllocationReport idleReport, dragReport;
+
+	for (int i = 0; i < STEADY_FRAME_WARM_UP_COUNT; i++)
+		RunFrame(gameController, renderList, renderCommandList, cardSize);
+
+	idleReport.Reset();
+	for (int i = 0; i < STEADY_FRAME_COUNT; i++)
+	{
+		idleReport.BeginFrame();
+		RunFrame(gameController, renderList, renderCommandList, cardSize);
+		idleReport.EndFrame();
+	}
+
+	bool passed = ReportFrameAllocations("idle", idleReport);
+
+	// Drag the top card of the first pile that lets one be picked up back and forth across the table.
+	const SolitaireGame* game = gameController.GetGame();
+	Vector2D grabPoint(0.0f, 0.0f);
+	bool grabbed = false;
+	for (int i = 0; i < game->GetPileCount() && !grabbed; i++)
+	{
+		const SolitaireGame::CardPile* cardPile = game->GetPile(i);
+		if (cardPile->cardArray.size() == 0)
+			continue;
+
+		grabPoint = PointOnCard(cardPile, int(cardPile->cardArray.size()) - 1, cardSize);
+		grabbed = gameController.OnMouseGrab(grabPoint);
+	}
+
+	if (!grabbed)
+	{
+		printf("%-8s No card could be picked up, so dragging wasn't checked.\n", "drag");
+		return passed;
+	}
+
+	auto dragPoint = [&grabPoint](int frame) -> Vector2D {
+		float t = float(frame % 60) / 60.0f;
+		return grabPoint + Vector2D(40.0f, 20.0f) * ((t < 0.5f) ? t : 1.0f - t);
+	};
+
+	for (int i = 0; i < STEADY_FRAME_WARM_UP_COUNT; i++)
+	{
+		gameController.OnMouseMove(dragPoint(i));
+		RunFrame(gameController, renderList, renderCommandList, cardSize);
+	}
+
+	dragReport.Reset();
+	for (int i = 0; i < STEADY_FRAME_COUNT; i++)
+	{
+		dragReport.BeginFrame();
+		gameController.OnMouseMove(dragPoint(i));
+		RunFrame(gameController, renderList, renderCommandList, cardSize);
+		dragReport.EndFrame();
+	}
+
+	// Dropping the cards back where they came from makes no move.
+	gameController.OnMouseRelease(grabPoint);
+
+	return ReportFrameAllocations("drag", dragReport) && passed;
+}
+
+static bool CheckRecord(const std::string& recordFilePath, const SolitaireGame* game)
+{
+	std::vector<uint8_t> byteArray;
+	GameRecordReader reader;
+	if (!GameRecordReader::LoadFile(recordFilePath, byteArray) || !reader.SetData(byteArray.data(), byteArray.size()))
+	{
+		fprintf(stderr, "Failed to read \"%s\".\n", recordFilePath.c_str());
+		return false;
+	}
+
+	// The game just played is the last in the file.
+	GameRecord::Header header, lastHeader;
+	std::vector<SolitaireGame::Move> moveArray, lastMoveArray;
+	int gameCount = 0;
+	while (reader.NextGame(header, moveArray))
+	{
+		lastHeader = header;
+		lastMoveArray.swap(moveArray);
+		gameCount++;
+	}
+
+	if (gameCount == 0)
+	{
+		fprintf(stderr, "No games in \"%s\".\n", recordFilePath.c_str());
+		return false;
+	}
+
+	Box worldExtents = SolitaireGame::MakeWorldExtents();
+	Box cardSize = SolitaireGame::MakeCardSize();
+
+	std::shared_ptr<SolitaireGame> recordedGame = GameRecordReader::Reconstruct(lastHeader, lastMoveArray, int(lastMoveArray.size()), worldExtents, cardSize);
+	bool matched = recordedGame.get() && recordedGame->GetHash() == game->GetHash();
+
+	printf("Record holds %d games in %d bytes; this one has %d moves and %s.\n", gameCount, int(byteArray.size()),
+		int(lastMoveArray.size()), matched ? "reconstructs to the same hash" : "DOES NOT reconstruct to the same hash");
+	return matched;
+}
+
+static int ReplayScript(const std::string& filePath, const std::string& recordFilePath, int expectedMove, uint64_t expectedHash)
+{
+	InputScript script;
+	if (!script.Load(filePath))
+	{
+		fprintf(stderr, "Failed to load \"%s\".\n", filePath.c_str());
+		return 1;
+	}
+
+	std::shared_ptr<SolitaireGame> game = MakeGame(script.variantName);
+	if (!game.get())
+	{
+		fprintf(stderr, "Unknown variant \"%s\".\n", script.variantName.c_str());
+		return 1;
+	}
+
+	game->NewGame(script.seed);
+
+	GameRecordWriter recordWriter;
+	if (!recordFilePath.empty() && !recordWriter.Open(recordFilePath))
+	{
+		fprintf(stderr, "Failed to open \"%s\" for recording.\n", recordFilePath.c_str());
+		return 1;
+	}
+
+	GameController gameController;
+	gameController.SetGame(game);
+	if (recordWriter.IsOpen())
+		gameController.SetGameRecordWriter(&recordWriter);
+
+	std::vector<double> latencyArray[InputScript::Event::Type::NUM_TYPES];
+	std::vector<double> tickLatencyArray;
+	double gameTime = 0.0;
+	Clock clock;
+
+	for (const InputScript::Event& event : script.eventArray)
+	{
+		TickUntil(gameController, gameTime, event.timeSeconds, &tickLatencyArray);
+
+		clock.Reset();
+		DispatchEvent(gameController, event);
+		latencyArray[event.type].push_back(clock.GetCurrentTimeMilliseconds() * 1000.0);
+	}
+
+	printf("%-8s %8s %10s %10s %10s %10s\n", "event", "count", "p50 (us)", "p90 (us)", "p99 (us)", "max (us)");
+	for (int i = 0; i < InputScript::Event::Type::NUM_TYPES; i++)
+		ReportLatencies(InputScript::GetEventName(InputScript::Event::Type(i)), latencyArray[i]);
+	ReportLatencies("tick", tickLatencyArray);
+
+	// These let two replays of the same script be checked against each other.
+	printf("Ended on move %d of %d with hash %016llx%s.\n",
+		gameController.GetHistory().GetCurrentMove(), gameController.GetHistory().GetMoveCount(),
+		(unsigned long long)game->GetHash(), game->GameWon() ? ", won" : "");
+
+	if (expectedMove >= 0 && (gameController.GetHistory().GetCurrentMove() != expectedMove || game->GetHash() != expectedHash))
+	{
+		fprintf(stderr, "Expected to end on move %d with hash %016llx.\n", expectedMove, (unsigned long long)expectedHash);
+		return 1;
+	}
+
+	if (recordWriter.IsOpen())
+	{
+		gameController.SetGameRecordWriter(nullptr);
+		recordWriter.Close();
+		if (!CheckRecord(recordFilePath, game.get()))
+			return 1;
+	}
+
+	Box cardSize = SolitaireGame::MakeCardSize();
+
+	if (!CheckSteadyFrames(gameController, cardSize))
+		return 1;
+
+	return 0;
+}
+
+static int GenerateScript(const std::string& variantName, uint64_t seed, int moveCount, const std::string& filePath)
+{
+	std::shared_ptr<SolitaireGame> game = MakeGame(variantName);
+	if (!game.get())
+	{
+		fprintf(stderr, "Unknown variant \"%s\".\n", variantName.c_str());
+		return 1;
+	}
+
+	game->NewGame(seed);
+
+	GameController gameController;
+	gameController.SetGame(game);
+
+	InputScript script;
+	script.variantName = variantName;
+	script.seed = seed;
+
+	Box cardSize = SolitaireGame::MakeCardSize();
+
+	// Play random legal moves through the mouse, as a player would, now and then taking
+	// one back, playing each event as it's added so that the next one can be aimed.
+	Random random(seed);
+	double gameTime = 0.0;
+	double timeSeconds = 1.0;
+	int missCount = 0;
+	std::vector<SolitaireGame::Move> moveArray;
+
+	auto addEvent = [&](InputScript::Event::Type type, const Vector2D& worldPoint) {
+		TickUntil(gameController, gameTime, timeSeconds, nullptr);
+		script.AddEvent(type, timeSeconds, worldPoint);
+		DispatchEvent(gameController, script.eventArray.back());
+	};
+
+	for (int i = 0; i < moveCount && !game->GameWon(); i++)
+	{
+		if (gameController.GetHistory().CanUndo() && random.IntegerInRange(0, 9) == 0)
+		{
+			addEvent(InputScript::Event::Type::UNDO, Vector2D(0.0f, 0.0f));
+			timeSeconds += 0.25;
+			continue;
+		}
+
+		moveArray.clear();
+		game->GenerateMoves(moveArray);
+		moveArray.erase(std::remove_if(moveArray.begin(), moveArray.end(), [](const SolitaireGame::Move& move) {
+			return move.type == SolitaireGame::Move::Type::REMOVE_CARDS;
+		}), moveArray.end());
+
+		if (moveArray.size() == 0)
+			break;
+
+		const SolitaireGame::Move& move = moveArray[random.IntegerInRange(0, int(moveArray.size()) - 1)];
+		if (move.type == SolitaireGame::Move::Type::DEAL_CARDS)
+		{
+			addEvent(InputScript::Event::Type::CARDS_NEEDED, Vector2D(0.0f, 0.0f));
+			timeSeconds += MIN_TIME_BETWEEN_CARDS_NEEDED * 2.0;
+			continue;
+		}
+
+		int moveNumber = gameController.GetHistory().GetCurrentMove();
+
+		const SolitaireGame::CardPile* sourcePile = game->GetPile(move.sourcePile);
+		Vector2D grabPoint = PointOnCard(sourcePile, int(sourcePile->cardArray.size()) - int(move.cardCount), cardSize);
+		const SolitaireGame::CardPile* targetPile = game->GetPile(move.targetPile);
+		Vector2D releasePoint = PointOnCard(targetPile, int(targetPile->cardArray.size()) - 1, cardSize);
+
+		addEvent(InputScript::Event::Type::MOUSE_GRAB, grabPoint);
+		for (int j = 1; j <= 4; j++)
+		{
+			timeSeconds += REPLAY_FRAME_TIME;
+			addEvent(InputScript::Event::Type::MOUSE_MOVE, grabPoint + (releasePoint - grabPoint) * (float(j) / 4.0f));
+		}
+
+		timeSeconds += REPLAY_FRAME_TIME;
+		addEvent(InputScript::Event::Type::MOUSE_RELEASE, releasePoint);
+		timeSeconds += 0.25;
+
+		if (gameController.GetHistory().GetCurrentMove() == moveNumber)
+			missCount++;
+	}
+
+	if (!script.Save(filePath))
+	{
+		fprintf(stderr, "Failed to write \"%s\".\n", filePath.c_str());
+		return 1;
+	}
+
+	printf("Wrote %d events; %d drags didn't land a move.  Ended with hash %016llx.\n",
+		int(script.eventArray.size()), missCount, (unsigned long long)game->GetHash());
+	return 0;
+}
+
+int main(int argc, char** argv)
+{
+	// A replay can be made to fail unless it ends where it's expected to.
+	int expectedMove = -1;
+	uint64_t expectedHash = 0;
+	if (argc >= 5 && ::strcmp(argv[argc - 3], "--expect") == 0)
+	{
+		expectedMove = std::atoi(argv[argc - 2]);
+		expectedHash = std::strtoull(argv[argc - 1], nullptr, 16);
+		argc -= 3;
+	}
+
+	if (argc == 2 || (argc == 3 && ::strncmp(argv[1], "--", 2) != 0))
+		return ReplayScript(argv[1], (argc == 3) ? argv[2] : "", expectedMove, expectedHash);
+
+	if (argc == 6 && ::strcmp(argv[1], "--generate") == 0)
+		return GenerateScript(argv[2], std::strtoull(argv[3], nullptr, 10), std::atoi(argv[4]), argv[5]);
+
+	fprintf(stderr, "Usage: %s <script file> [<record file>] [--expect <move number> <hash>]\n", argv[0]);
+	fprintf(stderr, "       %s --generate <variant> <seed> <move count> <script file>\n", argv[0]);
+	fprintf(stderr, "Variants: klondike, freecell, spider-low, spider-medium, spider-hard\n");
+	return 1;
+}
\ No newline at end of file
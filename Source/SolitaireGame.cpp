@@ -1,7 +1,9 @@
 #include "SolitaireGame.h"
-#include <format>
-
-using namespace DirectX;
+#include <string>
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+#include <stdlib.h>
 
 //----------------------------------- SolitaireGame -----------------------------------
 
@@ -9,260 +11,559 @@ SolitaireGame::SolitaireGame(const Box& worldExtents, const Box& cardSize)
 {
 	this->worldExtents = worldExtents;
 	this->cardSize = cardSize;
-	this->grabDelta = XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f);
+	this->grabDelta = Vector2D(0.0f, 0.0f);
+	this->tableauPileCount = 0;
+	this->originPileIndex = -1;
+	this->moveListener = nullptr;
+	this->hash = 0;
 }
 
 /*virtual*/ SolitaireGame::~SolitaireGame()
 {
 }
 
+/*static*/ Box SolitaireGame::MakeWorldExtents()
+{
+	Box worldExtents;
+	worldExtents.min = Vector2D(0.0f, 0.0f);
+	worldExtents.max = Vector2D(float(TABLE_WORLD_WIDTH), float(TABLE_WORLD_HEIGHT));
+	return worldExtents;
+}
+
+/*static*/ Box SolitaireGame::MakeCardSize()
+{
+	Box cardSize;
+	cardSize.min = Vector2D(0.0f, 0.0f);
+	cardSize.max = Vector2D(float(CARD_WORLD_WIDTH), float(CARD_WORLD_WIDTH / CARD_ASPECT_RATIO));
+	return cardSize;
+}
+
 /*virtual*/ std::shared_ptr<SolitaireGame> SolitaireGame::Clone() const
 {
 	auto game = this->AllocNew();
 
-	for (const std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
-		game->cardPileArray.push_back(cardPile->Clone());
+	game->cardPileArray = this->cardPileArray;
+	game->tableauPileCount = this->tableauPileCount;
+	game->random = this->random;
+	game->hash = this->hash;
 
 	return game;
 }
 
-/*virtual*/ void SolitaireGame::GenerateRenderList(std::vector<const Card*>& cardRenderList) const
+void SolitaireGame::NewGame()
+{
+	this->NewGame(Random::MakeSeed());
+}
+
+uint64_t SolitaireGame::GetSeed() const
+{
+	return this->random.GetSeed();
+}
+
+/*virtual*/ void SolitaireGame::GenerateRenderList(std::vector<RenderItem>& renderList) const
 {
 	for (const std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
-		cardPile->GenerateRenderList(cardRenderList);
+		cardPile->GenerateRenderList(renderList);
 
 	if (this->movingCardPile.get())
-		this->movingCardPile->GenerateRenderList(cardRenderList);
+		this->movingCardPile->GenerateRenderList(renderList);
 }
 
-/*static*/ void SolitaireGame::GenerateDeck(std::vector<std::shared_ptr<Card>>& cardArray)
+/*static*/ void SolitaireGame::GenerateDeck(std::vector<Card>& cardArray)
 {
 	for (int i = 0; i < (int)Card::NUM_SUITS; i++)
-	{
 		for (int j = 0; j < (int)Card::NUM_VALUES; j++)
-		{
-			auto card = std::make_shared<Card>();
-			card->suit = (Card::Suit)i;
-			card->value = (Card::Value)j;
-			cardArray.push_back(card);
-		}
-	}
+			cardArray.push_back(Card((Card::Value)j, (Card::Suit)i));
 }
 
-/*static*/ void SolitaireGame::SuffleCards(std::vector<std::shared_ptr<Card>>& cardArray)
+void SolitaireGame::SuffleCards(std::vector<Card>& cardArray)
 {
 	for (int i = int(cardArray.size()) - 1; i >= 0; i--)
 	{
 		int j = RandomInteger(0, i);
 		if (j != i)
 		{
-			std::shared_ptr<Card> card = cardArray[i];
+			Card card = cardArray[i];
 			cardArray[i] = cardArray[j];
 			cardArray[j] = card;
 		}
 	}
 }
 
-/*static*/ int SolitaireGame::RandomInteger(int min, int max)
+int SolitaireGame::RandomInteger(int min, int max)
+{
+	return this->random.IntegerInRange(min, max);
+}
+
+/*static*/ bool SolitaireGame::CardGoesOnSuitPile(const Card& card, const CardPile* suitPile)
 {
-	double alpha = double(std::rand()) / double(RAND_MAX);
-	double value = (1.0 - alpha) * (double(min) - 0.5) + alpha * (double(max) + 0.5);
-	int roundedValue = (int)::round(value);
-	if (roundedValue < min)
-		roundedValue = min;
-	if (roundedValue > max)
-		roundedValue = max;
-	return roundedValue;
+	if (suitPile->cardArray.size() == 0)
+		return card.GetValue() == Card::Value::ACE;
+
+	Card topCard = suitPile->cardArray.back();
+	return topCard.GetSuit() == card.GetSuit() && int(topCard.GetValue()) + 1 == int(card.GetValue());
 }
 
 /*virtual*/ void SolitaireGame::Clear()
 {
 	this->cardPileArray.clear();
+	this->tableauPileCount = 0;
 	this->movingCardPile.reset();
+	this->originPileIndex = -1;
+	this->hash = 0;
+	this->pileGridStaleArray.clear();
 }
 
-bool SolitaireGame::FindCardInPile(DirectX::XMVECTOR worldPoint, std::shared_ptr<CardPile> givenCardPile, int& foundCardOffset)
+SolitaireGame::CardPile* SolitaireGame::EditPile(int pileIndex)
 {
-	// Search from top to bottom to account for Z-order.
-	for (int i = int(givenCardPile->cardArray.size()) - 1; i >= 0; i--)
-	{
-		std::shared_ptr<Card>& card = givenCardPile->cardArray[i];
-		if (card->ContainsPoint(worldPoint, this->cardSize))
-		{
-			foundCardOffset = i;
-			return true;
-		}
-	}
+	std::shared_ptr<CardPile>& cardPile = this->cardPileArray[pileIndex];
 
-	return false;
+	// Copy the pile if anyone else can see it.
+	if (cardPile.use_count() > 1)
+		cardPile = cardPile->Clone();
+
+	if (pileIndex < int(this->pileGridStaleArray.size()))
+		this->pileGridStaleArray[pileIndex] = true;
+
+	return cardPile.get();
 }
 
-bool SolitaireGame::FindCardAndPile(DirectX::XMVECTOR worldPoint, std::shared_ptr<CardPile>& foundCardPile, int& foundCardOffset)
+bool SolitaireGame::FindCardInPile(Vector2D worldPoint, int pileIndex, int& foundCardOffset) const
 {
-	for (std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
+	int cardOffset = this->cardPileArray[pileIndex]->CardIndexAtPoint(worldPoint, this->cardSize);
+	if (cardOffset < 0)
+		return false;
+
+	foundCardOffset = cardOffset;
+	return true;
+}
+
+bool SolitaireGame::FindCardAndPile(Vector2D worldPoint, int& foundPileIndex, int& foundCardOffset) const
+{
+	this->UpdatePileGrid();
+
+	// Piles overlapping under the point are taken in order, just as if they'd all been searched.
+	this->pileHitArray.clear();
+	this->pileGrid.FindEntriesAt(worldPoint, this->pileHitArray);
+
+	int pileIndex = this->tableauPileCount;
+	int cardOffset = -1;
+	for (const SpatialGrid::Entry& entry : this->pileHitArray)
 	{
-		if (this->FindCardInPile(worldPoint, cardPile, foundCardOffset))
+		if (int(entry.owner) >= pileIndex)
+			continue;
+
+		int offset = this->cardPileArray[entry.owner]->CardIndexAtPoint(worldPoint, this->cardSize);
+		if (offset >= 0)
 		{
-			foundCardPile = cardPile;
-			return true;
+			pileIndex = entry.owner;
+			cardOffset = offset;
 		}
 	}
 
-	return false;
+	if (cardOffset < 0)
+		return false;
+
+	foundPileIndex = pileIndex;
+	foundCardOffset = cardOffset;
+	return true;
 }
 
-bool SolitaireGame::FindEmptyPile(DirectX::XMVECTOR worldPoint, std::shared_ptr<CardPile>& foundCardPile)
+bool SolitaireGame::FindEmptyPile(Vector2D worldPoint, int& foundPileIndex) const
 {
-	for (std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
+	this->UpdatePileGrid();
+
+	this->pileHitArray.clear();
+	this->pileGrid.FindEntriesAt(worldPoint, this->pileHitArray);
+
+	// An empty pile's box in the grid is just its place-holder.
+	int pileIndex = this->tableauPileCount;
+	for (const SpatialGrid::Entry& entry : this->pileHitArray)
+		if (int(entry.owner) < pileIndex && this->cardPileArray[entry.owner]->cardArray.size() == 0)
+			pileIndex = entry.owner;
+
+	if (pileIndex == this->tableauPileCount)
+		return false;
+
+	foundPileIndex = pileIndex;
+	return true;
+}
+
+void SolitaireGame::UpdatePileGrid() const
+{
+	int pileCount = int(this->cardPileArray.size());
+	if (int(this->pileGridStaleArray.size()) != pileCount)
 	{
-		if (cardPile->cardArray.size() > 0)
+		this->pileGrid.Reset(this->worldExtents, this->cardSize.GetWidth(), this->cardSize.GetHeight(), pileCount);
+		this->pileGridStaleArray.assign(pileCount, true);
+	}
+
+	for (int i = 0; i < pileCount; i++)
+	{
+		if (!this->pileGridStaleArray[i])
 			continue;
 
-		if (cardPile->ContainsPoint(worldPoint, this->cardSize))
-		{
-			foundCardPile = cardPile;
-			return true;
-		}
+		this->pileGridStaleArray[i] = false;
+		this->pileGrid.RemoveOwner(i);
+		this->pileGrid.Insert(i, 0, this->cardPileArray[i]->GetBounds(this->cardSize));
 	}
-
-	return false;
 }
 
-void SolitaireGame::StartCardMoving(std::shared_ptr<CardPile> cardPile, int grabOffset, XMVECTOR grabPoint)
+void SolitaireGame::StartCardMoving(int pileIndex, int grabOffset, Vector2D grabPoint)
 {
 	this->movingCardPile = std::make_shared<CascadingCardPile>();
 
-	for (int i = grabOffset; i < cardPile->cardArray.size(); i++)
-		this->movingCardPile->cardArray.push_back(cardPile->cardArray[i]);
-
-	for (int i = 0; i < this->movingCardPile->cardArray.size(); i++)
-		cardPile->cardArray.pop_back();
+	// Cards in hand are in no pile, so they're out of the hash until they're dropped.
+	this->HashCards(pileIndex, grabOffset, int(this->cardPileArray[pileIndex]->cardArray.size()) - grabOffset);
+	this->EditPile(pileIndex)->MoveCardsTo(this->movingCardPile.get(), grabOffset);
 
-	this->movingCardPile->position = this->movingCardPile->cardArray[0]->position;
+	// Once laid out in hand, the cards are only ever translated as the mouse moves.
+	this->movingCardPile->position = this->movingCardPile->visualArray[0].position;
+	this->movingCardPile->UpdateLayout(this->cardSize);
 	this->grabDelta = this->movingCardPile->position - grabPoint;
-	this->originCardPile = cardPile;
+	this->originPileIndex = pileIndex;
 }
 
-void SolitaireGame::FinishCardMoving(std::shared_ptr<CardPile> targetPile, bool commitMove)
+void SolitaireGame::FinishCardMoving(int targetPileIndex, bool commitMove)
 {
+	CardPile* originPile = this->EditPile(this->originPileIndex);
+
 	if (commitMove)
 	{
-		for (auto& movingCard : this->movingCardPile->cardArray)
-			targetPile->cardArray.push_back(movingCard);
+		CardPile* targetPile = this->EditPile(targetPileIndex);
+
+		Move move(Move::Type::MOVE_CARDS, this->originPileIndex, targetPileIndex, int(this->movingCardPile->cardArray.size()));
+
+		this->movingCardPile->MoveCardsTo(targetPile, 0);
+		this->HashCards(targetPileIndex, int(targetPile->cardArray.size()) - int(move.cardCount), int(move.cardCount));
 
-		targetPile->LayoutCards(this->cardSize);
+		targetPile->UpdateLayout(this->cardSize);
+		originPile->UpdateLayout(this->cardSize);
 
-		if (this->originCardPile->cardArray.size() > 0)
-			this->originCardPile->cardArray[this->originCardPile->cardArray.size() - 1]->orientation = Card::Orientation::FACE_UP;
+		if (originPile->cardArray.size() > 0 && originPile->cardArray.back().GetOrientation() == Card::Orientation::FACE_DOWN)
+		{
+			this->TurnTopCard(this->originPileIndex, Card::Orientation::FACE_UP);
+			move.flags |= Move::Flags::FLIPPED_CARD;
+		}
+
+		// Dropping cards back where they came from changes nothing worth recording.
+		if (targetPileIndex != this->originPileIndex)
+			this->CommitMove(move);
 	}
 	else
 	{
-		for (auto& movingCard : this->movingCardPile->cardArray)
-			this->originCardPile->cardArray.push_back(movingCard);
+		int cardCount = int(this->movingCardPile->cardArray.size());
+		this->movingCardPile->MoveCardsTo(originPile, 0);
+		this->HashCards(this->originPileIndex, int(originPile->cardArray.size()) - cardCount, cardCount);
 
-		this->originCardPile->LayoutCards(this->cardSize);
+		originPile->UpdateLayout(this->cardSize);
 	}
 
 	this->movingCardPile = nullptr;
+	this->originPileIndex = -1;
 }
 
-void SolitaireGame::ManageCardMoving(XMVECTOR grabPoint)
+void SolitaireGame::CancelCardMoving()
 {
 	if (this->movingCardPile.get())
+		this->FinishCardMoving(this->originPileIndex, false);
+}
+
+void SolitaireGame::CommitMove(const Move& move)
+{
+	if (this->moveListener)
+		this->moveListener->OnMoveCommitted(this, move);
+}
+
+void SolitaireGame::SetMoveListener(MoveListener* moveListener)
+{
+	this->moveListener = moveListener;
+}
+
+int SolitaireGame::GetPileCount() const
+{
+	return int(this->cardPileArray.size());
+}
+
+const SolitaireGame::CardPile* SolitaireGame::GetPile(int pileIndex) const
+{
+	return this->cardPileArray[pileIndex].get();
+}
+
+/*virtual*/ void SolitaireGame::GenerateMoves(std::vector<Move>& moveArray) const
+{
+	int pileCount = int(this->cardPileArray.size());
+
+	for (int i = 0; i < pileCount; i++)
 	{
-		this->movingCardPile->position = grabPoint + this->grabDelta;
-		this->movingCardPile->LayoutCards(this->cardSize);
+		const CardPile* sourcePile = this->cardPileArray[i].get();
+		int sourceCount = int(sourcePile->cardArray.size());
+
+		for (int j = sourceCount - 1; j >= 0 && this->CanPickUpCards(i, j); j--)
+		{
+			Card card = sourcePile->cardArray[j];
+			int cardCount = sourceCount - j;
+
+			uint8_t flags = 0;
+			if (j > 0 && sourcePile->cardArray[j - 1].GetOrientation() == Card::Orientation::FACE_DOWN)
+				flags |= Move::Flags::FLIPPED_CARD;
+
+			for (int k = 0; k < pileCount; k++)
+				if (k != i && this->CanPlaceCards(card, cardCount, k))
+					moveArray.push_back(Move(Move::Type::MOVE_CARDS, i, k, cardCount, flags));
+		}
 	}
 }
 
-/*virtual*/ void SolitaireGame::Tick(double deltaTimeSeconds)
+/*virtual*/ void SolitaireGame::ApplyMove(const Move& move)
 {
-	for (std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
-		for (std::shared_ptr<Card>& card : cardPile->cardArray)
-			card->Tick(deltaTimeSeconds);
+	if (move.type == Move::Type::MOVE_CARDS)
+	{
+		CardPile* sourcePile = this->EditPile(move.sourcePile);
+		CardPile* targetPile = this->EditPile(move.targetPile);
+
+		assert(int(move.cardCount) <= int(sourcePile->cardArray.size()));
+		this->HashCards(move.sourcePile, int(sourcePile->cardArray.size()) - int(move.cardCount), int(move.cardCount));
+		sourcePile->MoveCardsTo(targetPile, int(sourcePile->cardArray.size()) - int(move.cardCount));
+		this->HashCards(move.targetPile, int(targetPile->cardArray.size()) - int(move.cardCount), int(move.cardCount));
+
+		if ((move.flags & Move::Flags::FLIPPED_CARD) != 0)
+			this->TurnTopCard(move.sourcePile, Card::Orientation::FACE_UP);
+
+		sourcePile->UpdateLayout(this->cardSize);
+		targetPile->UpdateLayout(this->cardSize);
+	}
 }
 
-//----------------------------------- SolitaireGame::Card -----------------------------------
+/*virtual*/ void SolitaireGame::UndoMove(const Move& move)
+{
+	if (move.type == Move::Type::MOVE_CARDS)
+	{
+		CardPile* sourcePile = this->EditPile(move.sourcePile);
+		CardPile* targetPile = this->EditPile(move.targetPile);
+
+		if ((move.flags & Move::Flags::FLIPPED_CARD) != 0)
+			this->TurnTopCard(move.sourcePile, Card::Orientation::FACE_DOWN);
 
-SolitaireGame::Card::Card()
+		assert(int(move.cardCount) <= int(targetPile->cardArray.size()));
+		this->HashCards(move.targetPile, int(targetPile->cardArray.size()) - int(move.cardCount), int(move.cardCount));
+		targetPile->MoveCardsTo(sourcePile, int(targetPile->cardArray.size()) - int(move.cardCount));
+		this->HashCards(move.sourcePile, int(sourcePile->cardArray.size()) - int(move.cardCount), int(move.cardCount));
+
+		sourcePile->UpdateLayout(this->cardSize);
+		targetPile->UpdateLayout(this->cardSize);
+	}
+}
+
+/*virtual*/ bool SolitaireGame::CanApplyMove(const Move& move) const
 {
-	this->value = Value::ACE;
-	this->suit = Suit::SPADES;
-	this->orientation = Orientation::FACE_UP;
-	this->position = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-	this->targetPosition = this->position;
-	this->animationRate = 0.0;
+	if (move.type != Move::Type::MOVE_CARDS)
+		return false;
+
+	if (int(move.sourcePile) >= int(this->cardPileArray.size()) || int(move.targetPile) >= int(this->cardPileArray.size()) || move.sourcePile == move.targetPile)
+		return false;
+
+	int cardCount = int(this->cardPileArray[move.sourcePile]->cardArray.size());
+	if (move.cardCount == 0 || int(move.cardCount) > cardCount)
+		return false;
+
+	// A card can only be turned over if one is left uncovered.
+	if ((move.flags & Move::Flags::FLIPPED_CARD) != 0 && int(move.cardCount) == cardCount)
+		return false;
+
+	return true;
 }
 
-/*virtual*/ SolitaireGame::Card::~Card()
+/*virtual*/ bool SolitaireGame::CanUndoMove(const Move& move) const
 {
+	if (move.type != Move::Type::MOVE_CARDS)
+		return false;
+
+	if (int(move.sourcePile) >= int(this->cardPileArray.size()) || int(move.targetPile) >= int(this->cardPileArray.size()) || move.sourcePile == move.targetPile)
+		return false;
+
+	if (move.cardCount == 0 || int(move.cardCount) > int(this->cardPileArray[move.targetPile]->cardArray.size()))
+		return false;
+
+	// The card that was turned over must still be there to turn back.
+	if ((move.flags & Move::Flags::FLIPPED_CARD) != 0 && this->cardPileArray[move.sourcePile]->cardArray.size() == 0)
+		return false;
+
+	return true;
 }
 
-std::shared_ptr<SolitaireGame::Card> SolitaireGame::Card::Clone() const
+uint64_t SolitaireGame::GetHash() const
 {
-	auto card = std::make_shared<Card>();
-	card->value = this->value;
-	card->suit = this->suit;
-	card->orientation = this->orientation;
-	card->position = this->position;
-	card->targetPosition = this->targetPosition;
-	card->animationRate = this->animationRate;
-	return card;
+	return this->hash;
 }
 
-void SolitaireGame::Card::Tick(double deltaTimeSeconds)
+uint64_t SolitaireGame::CalcHash() const
 {
-	if (this->animationRate > 0.0f)
+	uint64_t hash = StockKey(this->GetStockCount());
+
+	for (int i = 0; i < int(this->cardPileArray.size()); i++)
 	{
-		XMVECTOR delta = this->targetPosition - this->position;
-		double currentDistance = XMVectorGetX(XMVector3Length(delta));
-		double travelDistance = this->animationRate * deltaTimeSeconds;
-		if (currentDistance <= travelDistance)
-		{
-			this->position = this->targetPosition;
-			this->animationRate = 0.0;
-		}
-		else
-		{
-			delta = XMVectorScale(delta, 1.0 / currentDistance) * travelDistance;
-			this->position += delta;
-		}
+		const CardPile* cardPile = this->cardPileArray[i].get();
+		for (int j = 0; j < int(cardPile->cardArray.size()); j++)
+			hash ^= CardKey(i, j, cardPile->cardArray[j]);
 	}
+
+	return hash;
 }
 
-bool SolitaireGame::Card::ContainsPoint(DirectX::XMVECTOR point, const Box& cardSize) const
+void SolitaireGame::SaveState(std::vector<uint8_t>& byteArray) const
 {
-	Box cardBox = cardSize;
-	cardBox.min += this->position;
-	cardBox.max += this->position;
-	return cardBox.ContainsPoint(point);
+	this->SaveCards(byteArray);
 }
 
-SolitaireGame::Card::Color SolitaireGame::Card::GetColor() const
+bool SolitaireGame::LoadState(const uint8_t*& data, const uint8_t* dataEnd)
 {
-	switch (this->suit)
+	if (!this->LoadCards(data, dataEnd))
+		return false;
+
+	this->hash = this->CalcHash();
+	return true;
+}
+
+/*virtual*/ void SolitaireGame::SaveCards(std::vector<uint8_t>& byteArray) const
+{
+	byteArray.push_back(uint8_t(this->cardPileArray.size()));
+
+	for (const std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
+		WriteCards(cardPile->cardArray, byteArray);
+}
+
+/*virtual*/ bool SolitaireGame::LoadCards(const uint8_t*& data, const uint8_t* dataEnd)
+{
+	if (data >= dataEnd || int(*data++) != int(this->cardPileArray.size()))
+		return false;
+
+	std::vector<Card> cardArray;
+	for (int i = 0; i < int(this->cardPileArray.size()); i++)
 	{
-	case Suit::SPADES:
-	case Suit::CLUBS:
-		return Color::BLACK;
-	case Suit::DIAMONDS:
-	case Suit::HEARTS:
-		return Color::RED;
+		if (!ReadCards(data, dataEnd, cardArray))
+			return false;
+
+		CardPile* cardPile = this->EditPile(i);
+		cardPile->ClearCards();
+		for (const Card& card : cardArray)
+			cardPile->AddCard(card);
+		cardPile->UpdateLayout(this->cardSize);
 	}
 
-	return Color::BLACK;
+	return true;
 }
 
+/*static*/ void SolitaireGame::WriteCards(const std::vector<Card>& cardArray, std::vector<uint8_t>& byteArray)
+{
+	// No pile or stock ever holds more than two decks' worth of cards, so the count fits in a byte.
+	assert(cardArray.size() <= 0xFF);
+	byteArray.push_back(uint8_t(cardArray.size()));
+
+	for (const Card& card : cardArray)
+		byteArray.push_back(card.bits);
+}
+
+/*static*/ bool SolitaireGame::ReadCards(const uint8_t*& data, const uint8_t* dataEnd, std::vector<Card>& cardArray)
+{
+	cardArray.clear();
+
+	if (data >= dataEnd || int(dataEnd - data) < 1 + int(*data))
+		return false;
+
+	int cardCount = *data++;
+	for (int i = 0; i < cardCount; i++)
+	{
+		Card card;
+		card.bits = *data++;
+		if ((card.bits & ~(Card::VALUE_MASK | Card::SUIT_MASK | Card::FACE_DOWN_BIT)) != 0 || card.GetValue() >= Card::Value::NUM_VALUES)
+			return false;
+
+		cardArray.push_back(card);
+	}
+
+	return true;
+}
+
+/*static*/ uint64_t SolitaireGame::CardKey(int pileIndex, int cardOffset, const Card& card)
+{
+	// This is the splitmix64 finalizer.
+	uint64_t key = (uint64_t(pileIndex) << 16) | (uint64_t(cardOffset) << 8) | uint64_t(card.bits);
+	key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+	key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+	key = key ^ (key >> 31);
+	return key * 0x9E3779B97F4A7C15ull + 1;
+}
+
+/*static*/ uint64_t SolitaireGame::StockKey(int stockCount)
+{
+	// An empty stock hashes to nothing, like an empty pile, so a cleared game hashes to zero.
+	if (stockCount == 0)
+		return 0;
+
+	return CardKey(0xFFFF, stockCount, Card::Empty());
+}
+
+void SolitaireGame::HashCards(int pileIndex, int firstOffset, int cardCount)
+{
+	const CardPile* cardPile = this->cardPileArray[pileIndex].get();
+	for (int i = firstOffset; i < firstOffset + cardCount; i++)
+		this->hash ^= CardKey(pileIndex, i, cardPile->cardArray[i]);
+}
+
+void SolitaireGame::TurnTopCard(int pileIndex, Card::Orientation orientation)
+{
+	CardPile* cardPile = this->EditPile(pileIndex);
+	int cardOffset = int(cardPile->cardArray.size()) - 1;
+
+	this->hash ^= CardKey(pileIndex, cardOffset, cardPile->cardArray.back());
+	cardPile->cardArray.back().SetOrientation(orientation);
+	this->hash ^= CardKey(pileIndex, cardOffset, cardPile->cardArray.back());
+}
+
+/*virtual*/ int SolitaireGame::GetStockCount() const
+{
+	return 0;
+}
+
+void SolitaireGame::ManageCardMoving(Vector2D grabPoint)
+{
+	if (this->movingCardPile.get())
+	{
+		this->movingCardPile->Translate(grabPoint + this->grabDelta - this->movingCardPile->position);
+	}
+}
+
+/*virtual*/ void SolitaireGame::Tick(double deltaTimeSeconds)
+{
+	for (int i = 0; i < int(this->cardPileArray.size()); i++)
+	{
+		// Only piles with cards in flight need to be touched (and therefore copied.)
+		if (this->cardPileArray[i]->IsAnimating())
+			this->EditPile(i)->Tick(deltaTimeSeconds);
+	}
+}
+
+//----------------------------------- SolitaireGame::Card -----------------------------------
+
+// The texture index is worked out at compile time wherever the card is known, and these keep it honest.
+static_assert(SolitaireGame::Card(SolitaireGame::Card::ACE, SolitaireGame::Card::SPADES).GetTextureIndex() == 0);
+static_assert(SolitaireGame::Card(SolitaireGame::Card::KING, SolitaireGame::Card::HEARTS).GetTextureIndex() == SolitaireGame::Card::CARD_BACK_TEXTURE - 1);
+static_assert(SolitaireGame::Card(SolitaireGame::Card::QUEEN, SolitaireGame::Card::CLUBS, SolitaireGame::Card::FACE_DOWN).GetTextureIndex() == SolitaireGame::Card::CARD_BACK_TEXTURE);
+static_assert(SolitaireGame::Card::Empty().GetTextureIndex() == SolitaireGame::Card::EMPTY_CARD_TEXTURE);
+static_assert(SolitaireGame::Card::FromTextureIndex(SolitaireGame::Card::EMPTY_CARD_TEXTURE - 1).GetTextureIndex() == SolitaireGame::Card::EMPTY_CARD_TEXTURE - 1);
+static_assert(SolitaireGame::Card::FromTextureIndex(17).GetTextureIndex() == 17);
+
 std::string SolitaireGame::Card::GetRenderKey() const
 {
-	if (this->value == Value::NUM_VALUES)
+	if (this->IsEmpty())
 		return "empty_card";
 
-	if (this->orientation == Orientation::FACE_DOWN)
+	if (this->GetOrientation() == Orientation::FACE_DOWN)
 		return "card_back";
 
 	std::string prefix;
-	switch (this->value)
+	switch (this->GetValue())
 	{
 	case Value::ACE:
 		prefix = "ace";
@@ -277,12 +578,12 @@ std::string SolitaireGame::Card::GetRenderKey() const
 		prefix = "king";
 		break;
 	default:
-		prefix = std::format("{}", int(this->value) + 1);
+		prefix = std::to_string(int(this->GetValue()) + 1);
 		break;
 	}
 
 	std::string postfix;
-	switch (this->suit)
+	switch (this->GetSuit())
 	{
 	case Suit::SPADES:
 		postfix = "spades";
@@ -296,38 +597,77 @@ std::string SolitaireGame::Card::GetRenderKey() const
 	case Suit::HEARTS:
 		postfix = "hearts";
 		break;
+	default:
+		assert(false);
+		break;
 	}
 
 	return prefix + "_of_" + postfix;
 }
 
-//----------------------------------- SolitaireGame::CardPile -----------------------------------
+/*static*/ void SolitaireGame::Card::GetAllRenderKeys(std::vector<std::string>& renderKeyArray)
+{
+	renderKeyArray.clear();
+	for (int i = 0; i < TextureIndex::NUM_TEXTURES; i++)
+		renderKeyArray.push_back(FromTextureIndex(i).GetRenderKey());
+}
 
-SolitaireGame::CardPile::CardPile()
+//----------------------------------- SolitaireGame::CardVisual -----------------------------------
+
+SolitaireGame::CardVisual::CardVisual()
 {
-	this->position = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
-	this->emptyCard = std::make_shared<Card>();
-	this->emptyCard->value = Card::Value::NUM_VALUES;
+	this->animationRate = 0.0;
 }
 
-/*virtual*/ SolitaireGame::CardPile::~CardPile()
+void SolitaireGame::CardVisual::Tick(double deltaTimeSeconds)
 {
+	if (this->animationRate > 0.0f)
+	{
+		Vector2D delta = this->targetPosition - this->position;
+		double currentDistance = delta.Length();
+		double travelDistance = this->animationRate * deltaTimeSeconds;
+		if (currentDistance <= travelDistance)
+		{
+			this->position = this->targetPosition;
+			this->animationRate = 0.0;
+		}
+		else
+		{
+			delta = delta * float(travelDistance / currentDistance);
+			this->position += delta;
+		}
+	}
 }
 
-/*virtual*/ std::shared_ptr<SolitaireGame::CardPile> SolitaireGame::CardPile::Clone() const
+bool SolitaireGame::CardVisual::ContainsPoint(const Vector2D& point, const Box& cardSize) const
 {
-	auto cardPile = this->AllocNew();
+	Box cardBox = cardSize;
+	cardBox.min += this->position;
+	cardBox.max += this->position;
+	return cardBox.ContainsPoint(point);
+}
 
-	cardPile->position = this->position;
-	cardPile->emptyCard = this->emptyCard;
+void SolitaireGame::CardVisual::PlaceAt(const Vector2D& newPosition)
+{
+	if (this->animationRate > 0.0)
+		this->targetPosition = newPosition;
+	else
+		this->position = newPosition;
+}
+
+//----------------------------------- SolitaireGame::CardPile -----------------------------------
 
-	for (const auto& card : this->cardArray)
-		cardPile->cardArray.push_back(card->Clone());
+SolitaireGame::CardPile::CardPile()
+{
+	this->layoutNeeded = true;
+	this->animatingCardCount = 0;
+}
 
-	return cardPile;
+/*virtual*/ SolitaireGame::CardPile::~CardPile()
+{
 }
 
-bool SolitaireGame::CardPile::ContainsPoint(DirectX::XMVECTOR point, const Box& cardSize) const
+bool SolitaireGame::CardPile::ContainsPoint(Vector2D point, const Box& cardSize) const
 {
 	Box pileBox = cardSize;
 	pileBox.min += this->position;
@@ -335,11 +675,169 @@ bool SolitaireGame::CardPile::ContainsPoint(DirectX::XMVECTOR point, const Box&
 	return pileBox.ContainsPoint(point);
 }
 
+Box SolitaireGame::CardPile::GetBounds(const Box& cardSize) const
+{
+	Box bounds = cardSize;
+	bounds.min += this->position;
+	bounds.max += this->position;
+
+	for (const CardVisual& visual : this->visualArray)
+	{
+		bounds.min.x = std::min(bounds.min.x, cardSize.min.x + visual.position.x);
+		bounds.min.y = std::min(bounds.min.y, cardSize.min.y + visual.position.y);
+		bounds.max.x = std::max(bounds.max.x, cardSize.max.x + visual.position.x);
+		bounds.max.y = std::max(bounds.max.y, cardSize.max.y + visual.position.y);
+	}
+
+	return bounds;
+}
+
+/*virtual*/ int SolitaireGame::CardPile::CardIndexAtPoint(const Vector2D& point, const Box& cardSize) const
+{
+	// Search from top to bottom to account for Z-order.
+	for (int i = int(this->cardArray.size()) - 1; i >= 0; i--)
+		if (this->visualArray[i].ContainsPoint(point, cardSize))
+			return i;
+
+	return -1;
+}
+
+bool SolitaireGame::CardPile::IsAnimating() const
+{
+	return this->animatingCardCount > 0;
+}
+
+void SolitaireGame::CardPile::Tick(double deltaTimeSeconds)
+{
+	if (this->animatingCardCount == 0)
+		return;
+
+	for (CardVisual& visual : this->visualArray)
+	{
+		if (visual.animationRate > 0.0)
+		{
+			visual.Tick(deltaTimeSeconds);
+			if (visual.animationRate == 0.0)
+				this->animatingCardCount--;
+		}
+	}
+
+	assert(this->animatingCardCount >= 0);
+}
+
+void SolitaireGame::CardPile::StartAnimation(int cardOffset, const Vector2D& startPosition, double animationRate)
+{
+	assert(this->IndexValid(cardOffset));
+	assert(animationRate > 0.0);
+
+	CardVisual& visual = this->visualArray[cardOffset];
+	if (visual.animationRate > 0.0)
+		this->animatingCardCount--;
+	else
+		visual.targetPosition = visual.position;
+
+	visual.position = startPosition;
+	visual.animationRate = animationRate;
+	this->animatingCardCount++;
+}
+
 bool SolitaireGame::CardPile::IndexValid(int i) const
 {
 	return 0 <= i && i < int(this->cardArray.size());
 }
 
+void SolitaireGame::CardPile::AddCard(const Card& card)
+{
+	this->AddCard(card, CardVisual());
+}
+
+void SolitaireGame::CardPile::AddCard(const Card& card, const CardVisual& visual)
+{
+	this->cardArray.push_back(card);
+	this->visualArray.push_back(visual);
+	this->layoutNeeded = true;
+
+	if (visual.animationRate > 0.0)
+		this->animatingCardCount++;
+}
+
+SolitaireGame::Card SolitaireGame::CardPile::RemoveCard()
+{
+	assert(this->cardArray.size() > 0);
+	Card card = this->cardArray.back();
+	if (this->visualArray.back().animationRate > 0.0)
+		this->animatingCardCount--;
+	this->cardArray.pop_back();
+	this->visualArray.pop_back();
+	this->layoutNeeded = true;
+	return card;
+}
+
+void SolitaireGame::CardPile::MoveCardsTo(CardPile* targetPile, int start)
+{
+	assert(0 <= start && start <= int(this->cardArray.size()));
+
+	if (targetPile == this)
+		return;
+
+	// Any cards in flight stay in flight.
+	if (this->animatingCardCount > 0)
+	{
+		for (int i = start; i < int(this->visualArray.size()); i++)
+		{
+			if (this->visualArray[i].animationRate > 0.0)
+			{
+				this->animatingCardCount--;
+				targetPile->animatingCardCount++;
+			}
+		}
+	}
+
+	targetPile->cardArray.insert(targetPile->cardArray.end(), this->cardArray.begin() + start, this->cardArray.end());
+	targetPile->visualArray.insert(targetPile->visualArray.end(), this->visualArray.begin() + start, this->visualArray.end());
+
+	this->cardArray.resize(start);
+	this->visualArray.resize(start);
+
+	this->layoutNeeded = true;
+	targetPile->layoutNeeded = true;
+}
+
+void SolitaireGame::CardPile::ClearCards()
+{
+	this->cardArray.clear();
+	this->visualArray.clear();
+	this->layoutNeeded = true;
+	this->animatingCardCount = 0;
+}
+
+void SolitaireGame::CardPile::UpdateLayout(const Box& cardSize)
+{
+	if (!this->NeedsLayout())
+		return;
+
+	this->LayoutCards(cardSize);
+	this->layoutNeeded = false;
+	this->layoutPosition = this->position;
+}
+
+bool SolitaireGame::CardPile::NeedsLayout() const
+{
+	return this->layoutNeeded || this->layoutPosition != this->position;
+}
+
+void SolitaireGame::CardPile::Translate(const Vector2D& delta)
+{
+	this->position += delta;
+	this->layoutPosition += delta;
+
+	for (CardVisual& visual : this->visualArray)
+	{
+		visual.position += delta;
+		visual.targetPosition += delta;
+	}
+}
+
 bool SolitaireGame::CardPile::CardsInOrder(int start, int finish) const
 {
 	assert(start <= finish);
@@ -351,10 +849,10 @@ bool SolitaireGame::CardPile::CardsInOrder(int start, int finish) const
 
 	for (int i = start; i < finish; i++)
 	{
-		const Card* cardA = this->cardArray[i].get();
-		const Card* cardB = this->cardArray[i + 1].get();
+		Card cardA = this->cardArray[i];
+		Card cardB = this->cardArray[i + 1];
 
-		if (int(cardA->value) - 1 != int(cardB->value))
+		if (int(cardA.GetValue()) - 1 != int(cardB.GetValue()))
 			return false;
 	}
 
@@ -367,9 +865,9 @@ bool SolitaireGame::CardPile::CardsSameColor(int start, int finish) const
 	assert(this->IndexValid(start));
 	assert(this->IndexValid(finish));
 
-	Card::Color color = this->cardArray[start]->GetColor();
+	Card::Color color = this->cardArray[start].GetColor();
 	for (int i = start + 1; i <= finish; i++)
-		if (this->cardArray[i]->GetColor() != color)
+		if (this->cardArray[i].GetColor() != color)
 			return false;
 
 	return true;
@@ -381,9 +879,9 @@ bool SolitaireGame::CardPile::CardsSameSuit(int start, int finish) const
 	assert(this->IndexValid(start));
 	assert(this->IndexValid(finish));
 
-	Card::Suit suit = this->cardArray[start]->suit;
+	Card::Suit suit = this->cardArray[start].GetSuit();
 	for (int i = start + 1; i <= finish; i++)
-		if (this->cardArray[i]->suit != suit)
+		if (this->cardArray[i].GetSuit() != suit)
 			return false;
 
 	return true;
@@ -398,10 +896,10 @@ bool SolitaireGame::CardPile::CardsAlternateColor(int start, int finish) const
 	int color = -1;
 	for (int i = start; i <= finish; i++)
 	{
-		if (color == int(this->cardArray[i]->GetColor()))
+		if (color == int(this->cardArray[i].GetColor()))
 			return false;
 
-		color = int(this->cardArray[i]->GetColor());
+		color = int(this->cardArray[i].GetColor());
 	}
 
 	return true;
@@ -425,60 +923,92 @@ SolitaireGame::CascadingCardPile::CascadingCardPile(CascadeDirection cascadeDire
 {
 }
 
-/*virtual*/ std::shared_ptr<SolitaireGame::CardPile> SolitaireGame::CascadingCardPile::AllocNew() const
-{
-	return std::make_shared<CascadingCardPile>();
-}
-
 /*virtual*/ std::shared_ptr<SolitaireGame::CardPile> SolitaireGame::CascadingCardPile::Clone() const
 {
-	auto cardPile = CardPile::Clone();
-
-	auto cascadingCardPile = dynamic_cast<CascadingCardPile*>(cardPile.get());
-	cascadingCardPile->cascadeDirection = this->cascadeDirection;
-	cascadingCardPile->cascadeNumber = this->cascadeNumber;
-
-	return cardPile;
+	return std::make_shared<CascadingCardPile>(*this);
 }
 
-/*virtual*/ void SolitaireGame::CascadingCardPile::GenerateRenderList(std::vector<const Card*>& cardRenderList) const
+/*virtual*/ void SolitaireGame::CascadingCardPile::GenerateRenderList(std::vector<RenderItem>& renderList) const
 {
 	if (this->cardArray.size() > 0)
 	{
 		// Render the cards from bottom to top of the pile.
-		for (const std::shared_ptr<Card>& card : this->cardArray)
-			cardRenderList.push_back(card.get());
+		for (int i = 0; i < int(this->cardArray.size()); i++)
+			renderList.push_back(RenderItem{ this->cardArray[i], this->visualArray[i].position });
 	}
 	else
 	{
-		cardRenderList.push_back(this->emptyCard.get());
+		renderList.push_back(RenderItem{ Card::Empty(), this->position });
 	}
 }
 
+Vector2D SolitaireGame::CascadingCardPile::GetCascadeDelta(const Box& cardSize) const
+{
+	switch (this->cascadeDirection)
+	{
+	case CascadeDirection::DOWN:
+		return Vector2D(0.0f, float(-cardSize.GetHeight() * 0.2f));
+	case CascadeDirection::RIGHT:
+		return Vector2D(float(cardSize.GetWidth() * 0.2f), 0.0f);
+	}
+
+	return Vector2D(0.0f, 0.0f);
+}
+
 /*virtual*/ void SolitaireGame::CascadingCardPile::LayoutCards(const Box& cardSize)
 {
-	XMVECTOR location = this->position;
-	XMVECTOR delta = XMVectorSet(0.0f, 0.0f, 0.0f, 0.0f);
+	Vector2D location = this->position;
+	Vector2D delta = this->GetCascadeDelta(cardSize);
 
+	for (int i = 0; i < (int)this->visualArray.size(); i++)
+	{
+		this->visualArray[i].PlaceAt(location);
+		if (this->cascadeNumber == -1 || (int(this->visualArray.size() - i) <= this->cascadeNumber))
+			location += delta;
+	}
+}
+
+/*virtual*/ int SolitaireGame::CascadingCardPile::CardIndexAtPoint(const Vector2D& point, const Box& cardSize) const
+{
+	int cardCount = int(this->cardArray.size());
+	if (cardCount == 0)
+		return -1;
+
+	// Cards in flight aren't where the layout puts them.
+	if (this->IsAnimating())
+		return CardPile::CardIndexAtPoint(point, cardSize);
+
+	// The cards below the last cascadeNumber are stacked at the pile's position, and each one above
+	// is a stride further along.  Find the last step along the cascade that puts a card over the point.
+	double stride = 0.0, lowerStep = 0.0, upperStep = 0.0;
 	switch (this->cascadeDirection)
 	{
 	case CascadeDirection::DOWN:
-		delta = XMVectorSet(0.0f, -cardSize.GetHeight() * 0.2f, 0.0f, 0.0f);
+		stride = cardSize.GetHeight() * 0.2;
+		lowerStep = (cardSize.min.y + this->position.y - point.y) / stride;
+		upperStep = (cardSize.max.y + this->position.y - point.y) / stride;
 		break;
 	case CascadeDirection::RIGHT:
-		delta = XMVectorSet(cardSize.GetWidth() * 0.2f, 0.0f, 0.0f, 0.0f);
+		stride = cardSize.GetWidth() * 0.2;
+		lowerStep = (point.x - this->position.x - cardSize.max.x) / stride;
+		upperStep = (point.x - this->position.x - cardSize.min.x) / stride;
 		break;
 	}
 
-	for (int i = 0; i < (int)this->cardArray.size(); i++)
-	{
-		std::shared_ptr<Card>& card = this->cardArray[i];
-		card->position = location;
-		if (this->cascadeNumber == -1 || (int(this->cardArray.size() - i) <= this->cascadeNumber))
-			location += delta;
-	}
+	int firstCascading = (this->cascadeNumber == -1) ? 0 : std::max(0, cardCount - this->cascadeNumber);
+	int stepCount = cardCount - 1 - firstCascading;
+	if (stride <= 0.0 || upperStep < -1.0 || lowerStep > double(stepCount + 1))
+		return -1;
 
-	this->emptyCard->position = this->position;
+	int step = std::clamp(int(::floor(upperStep)), 0, stepCount);
+	int cardOffset = firstCascading + step;
+
+	// The layout steps by repeated addition, so let the card boxes themselves settle a point right on an edge.
+	for (int i = std::min(cardOffset + 1, cardCount - 1); i >= std::max(cardOffset - 1, 0); i--)
+		if (this->visualArray[i].ContainsPoint(point, cardSize))
+			return i;
+
+	return -1;
 }
 
 //----------------------------------- SolitaireGame::SingularCardPile -----------------------------------
@@ -491,35 +1021,38 @@ SolitaireGame::SingularCardPile::SingularCardPile()
 {
 }
 
-/*virtual*/ std::shared_ptr<SolitaireGame::CardPile> SolitaireGame::SingularCardPile::AllocNew() const
-{
-	return std::make_shared<SingularCardPile>();
-}
-
 /*virtual*/ std::shared_ptr<SolitaireGame::CardPile> SolitaireGame::SingularCardPile::Clone() const
 {
-	auto cardPile = CardPile::Clone();
-
-	return cardPile;
+	return std::make_shared<SingularCardPile>(*this);
 }
 
-/*virtual*/ void SolitaireGame::SingularCardPile::GenerateRenderList(std::vector<const Card*>& cardRenderList) const
+/*virtual*/ void SolitaireGame::SingularCardPile::GenerateRenderList(std::vector<RenderItem>& renderList) const
 {
 	if (this->cardArray.size() > 0)
 	{
 		// Only the card on top of the pile renders.
-		cardRenderList.push_back(this->cardArray[this->cardArray.size() - 1].get());
+		renderList.push_back(RenderItem{ this->cardArray.back(), this->visualArray.back().position });
 	}
 	else
 	{
-		cardRenderList.push_back(this->emptyCard.get());
+		renderList.push_back(RenderItem{ Card::Empty(), this->position });
 	}
 }
 
 /*virtual*/ void SolitaireGame::SingularCardPile::LayoutCards(const Box& cardSize)
 {
-	this->emptyCard->position = this->position;
+	for (CardVisual& visual : this->visualArray)
+		visual.PlaceAt(this->position);
+}
+
+/*virtual*/ int SolitaireGame::SingularCardPile::CardIndexAtPoint(const Vector2D& point, const Box& cardSize) const
+{
+	if (this->IsAnimating())
+		return CardPile::CardIndexAtPoint(point, cardSize);
+
+	// All of the cards are in the one place, so only the top one can be under the point.
+	if (this->cardArray.size() > 0 && this->visualArray.back().ContainsPoint(point, cardSize))
+		return int(this->cardArray.size()) - 1;
 
-	for (std::shared_ptr<Card>& card : this->cardArray)
-		card->position = this->position;
+	return -1;
 }
\ No newline at end of file
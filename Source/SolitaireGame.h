@@ -2,9 +2,17 @@
 
 #include <vector>
 #include <memory>
-#include <DirectXMath.h>
-#include <random>
+#include <string>
+#include <stdint.h>
 #include "Box.h"
+#include "Random.h"
+#include "SpatialGrid.h"
+
+// These are the size of the table and of a card, in world units, that every game is laid out for.
+#define TABLE_WORLD_WIDTH				150.0
+#define TABLE_WORLD_HEIGHT				100.0
+#define CARD_WORLD_WIDTH				12.0
+#define CARD_ASPECT_RATIO				0.68870523415977961432506887052342
 
 class SolitaireGame
 {
@@ -13,31 +21,79 @@ public:
 	virtual ~SolitaireGame();
 
 	class Card;
+	struct RenderItem;
+	struct Move;
+	class CardPile;
+	class MoveListener;
 
 	virtual std::shared_ptr<SolitaireGame> AllocNew() const = 0;
+
+	// These are the world extents and card size that the window lays games out with.
+	// Anything else that lays out a game should use them too, so that its layout matches.
+	static Box MakeWorldExtents();
+	static Box MakeCardSize();
+
+	// The returned game shares all of its piles with this one.  Both games copy
+	// a pile before changing it, so taking a snapshot of the game for the undo
+	// history costs memory in proportion to the piles that actually change.
 	virtual std::shared_ptr<SolitaireGame> Clone() const;
-	virtual void NewGame() = 0;
-	virtual void GenerateRenderList(std::vector<const Card*>& cardRenderList) const;
+	// The same seed always deals the same game.  Without one, a new seed is made up.
+	virtual void NewGame(uint64_t seed) = 0;
+	void NewGame();
+	uint64_t GetSeed() const;
+
+	virtual void GenerateRenderList(std::vector<RenderItem>& renderList) const;
 	virtual void Clear();
-	virtual bool OnMouseGrabAt(DirectX::XMVECTOR worldPoint) = 0;
-	virtual bool OnMouseReleaseAt(DirectX::XMVECTOR worldPoint) = 0;
-	virtual void OnMouseMove(DirectX::XMVECTOR worldPoint) = 0;
+	virtual bool OnMouseGrabAt(Vector2D worldPoint) = 0;
+	virtual bool OnMouseReleaseAt(Vector2D worldPoint) = 0;
+	virtual void OnMouseMove(Vector2D worldPoint) = 0;
 	virtual bool OnCardsNeeded() = 0;
+	// Any cards in hand go back where they came from, as if dropped where they couldn't go.
+	void CancelCardMoving();
 	virtual void OnKeyUp(uint32_t keyCode) = 0;
 	virtual void Tick(double deltaTimeSeconds);
 	virtual bool GameWon() const = 0;
 
+	// This appends every move the rules currently allow.  Any of these may be given
+	// to ApplyMove() and then to UndoMove() to take it back again.
+	virtual void GenerateMoves(std::vector<Move>& moveArray) const;
+
+	// These make and take back a move, whether generated or previously reported to the
+	// move listener.  Only the cards involved are touched, and the move isn't reported.
+	virtual void ApplyMove(const Move& move);
+	virtual void UndoMove(const Move& move);
+
+	// These say whether a move read from a file can be given to ApplyMove() or UndoMove() in
+	// the current position without reaching for a pile or card that isn't there.  They're no
+	// check that the rules allow the move, only that making it leaves the game in one piece.
+	virtual bool CanApplyMove(const Move& move) const;
+	virtual bool CanUndoMove(const Move& move) const;
+
+	void SetMoveListener(MoveListener* moveListener);
+
+	int GetPileCount() const;
+	const CardPile* GetPile(int pileIndex) const;
+
+	// This is a Zobrist hash of the rules state: every card in every pile, where it is
+	// in the pile and which way up it is, and how many cards there are left to deal.
+	// It's kept up to date as cards move, so comparing positions by it is free, and
+	// CalcHash() works it out from scratch to check it against.
+	uint64_t GetHash() const;
+	uint64_t CalcHash() const;
+
+	// These write out and read back everything the rules need to carry on with a game: every
+	// card, wherever it is, but none of the visuals, which are laid out afresh.  Reading must be
+	// into a game freshly dealt from the same seed, as the piles themselves come from that deal,
+	// and a game left half read by a failure is good for nothing but to be thrown away.
+	void SaveState(std::vector<uint8_t>& byteArray) const;
+	bool LoadState(const uint8_t*& data, const uint8_t* dataEnd);
+
+	// This is the rules state of a card packed into a single byte so that piles
+	// of cards are small, contiguous and trivially copied, hashed and compared.
+	// Where a card is drawn on the table is kept separately in a CardVisual.
 	class Card
 	{
 	public:
-		Card();
-		virtual ~Card();
-
-		std::shared_ptr<Card> Clone() const;
-		std::string GetRenderKey() const;
-		bool ContainsPoint(DirectX::XMVECTOR point, const Box& cardSize) const;
-		void Tick(double deltaTimeSeconds);
-
 		enum Value
 		{
 			ACE,
@@ -77,25 +133,202 @@ public:
 			FACE_DOWN
 		};
 
-		Color GetColor() const;
+		// Bits 0-3 hold the value, bits 4-5 the suit and bit 6 the orientation.
+		// A value of NUM_VALUES denotes the place-holder drawn for an empty pile.
+		enum : uint8_t
+		{
+			VALUE_MASK = 0x0F,
+			SUIT_SHIFT = 4,
+			SUIT_MASK = 0x30,
+			FACE_DOWN_BIT = 0x40
+		};
+
+		// Every card drawn has a texture numbered by one of these: the faces
+		// by suit and then value, followed by the back and the empty pile.
+		enum TextureIndex
+		{
+			CARD_BACK_TEXTURE = int(Suit::NUM_SUITS) * int(Value::NUM_VALUES),
+			EMPTY_CARD_TEXTURE,
+			NUM_TEXTURES
+		};
+
+		constexpr Card()
+		{
+			this->bits = uint8_t(Value::ACE);
+		}
+
+		constexpr Card(Value value, Suit suit, Orientation orientation = Orientation::FACE_UP)
+		{
+			this->bits = uint8_t(uint8_t(value) | (uint8_t(suit) << SUIT_SHIFT) | ((orientation == Orientation::FACE_DOWN) ? FACE_DOWN_BIT : 0));
+		}
+
+		static constexpr Card Empty()
+		{
+			return Card(Value::NUM_VALUES, Suit::SPADES);
+		}
+
+		// This is a card that GetTextureIndex() gives the given index for.
+		static constexpr Card FromTextureIndex(int textureIndex)
+		{
+			if (textureIndex == TextureIndex::CARD_BACK_TEXTURE)
+				return Card(Value::ACE, Suit::SPADES, Orientation::FACE_DOWN);
+			if (textureIndex == TextureIndex::EMPTY_CARD_TEXTURE)
+				return Empty();
+			return Card(Value(textureIndex % Value::NUM_VALUES), Suit(textureIndex / Value::NUM_VALUES));
+		}
+
+		constexpr Value GetValue() const
+		{
+			return Value(this->bits & VALUE_MASK);
+		}
+
+		constexpr Suit GetSuit() const
+		{
+			return Suit((this->bits & SUIT_MASK) >> SUIT_SHIFT);
+		}
+
+		constexpr Orientation GetOrientation() const
+		{
+			return (this->bits & FACE_DOWN_BIT) ? Orientation::FACE_DOWN : Orientation::FACE_UP;
+		}
+
+		Color GetColor() const
+		{
+			// Diamonds and hearts are the two suits with the high suit bit set.
+			return (this->bits & (uint8_t(Suit::DIAMONDS) << SUIT_SHIFT)) ? Color::RED : Color::BLACK;
+		}
+
+		void SetOrientation(Orientation orientation)
+		{
+			if (orientation == Orientation::FACE_DOWN)
+				this->bits |= FACE_DOWN_BIT;
+			else
+				this->bits &= uint8_t(~FACE_DOWN_BIT);
+		}
+
+		constexpr bool IsEmpty() const
+		{
+			return this->GetValue() == Value::NUM_VALUES;
+		}
+
+		bool operator==(const Card& card) const
+		{
+			return this->bits == card.bits;
+		}
+
+		bool operator!=(const Card& card) const
+		{
+			return this->bits != card.bits;
+		}
+
+		// This is the file name of the card's texture, without its extension.
+		std::string GetRenderKey() const;
+
+		// These are the render keys of all the textures, in order of texture index.
+		static void GetAllRenderKeys(std::vector<std::string>& renderKeyArray);
+
+		constexpr int GetTextureIndex() const
+		{
+			if (this->IsEmpty())
+				return TextureIndex::EMPTY_CARD_TEXTURE;
+
+			if (this->GetOrientation() == Orientation::FACE_DOWN)
+				return TextureIndex::CARD_BACK_TEXTURE;
+
+			return int(this->GetSuit()) * Value::NUM_VALUES + int(this->GetValue());
+		}
+
+		uint8_t bits;
+	};
+
+	// This is where a card is drawn and where it's headed if it's animating.
+	class CardVisual
+	{
+	public:
+		CardVisual();
 
-		Value value;
-		Suit suit;
-		Orientation orientation;
-		DirectX::XMVECTOR position;
-		DirectX::XMVECTOR targetPosition;
+		void Tick(double deltaTimeSeconds);
+		bool ContainsPoint(const Vector2D& point, const Box& cardSize) const;
+
+		// A card still in flight is sent on to the new place rather than left to land where it was headed.
+		void PlaceAt(const Vector2D& newPosition);
+
+		Vector2D position;
+		Vector2D targetPosition;
 		double animationRate;
 	};
 
+	// One of these is generated for every card drawn in a frame.
+	struct RenderItem
+	{
+		Card card;
+		Vector2D position;
+	};
+
+	// This is a reversible record of one change made to the game.  It holds just
+	// enough to replay the change or take it back without a copy of the game.
+	struct Move
+	{
+		enum Type : uint8_t
+		{
+			MOVE_CARDS,			// The top cardCount cards of the source pile went onto the target pile.
+			DEAL_CARDS,			// The game dealt cardCount cards from its stock.
+			REMOVE_CARDS		// The game took cardCount completed cards off of the source pile.
+		};
+
+		enum Flags : uint8_t
+		{
+			FLIPPED_CARD = 0x01,	// The card uncovered on the source pile was turned face-up.
+			RECYCLED_STOCK = 0x02,	// The waste was turned back over into the stock before dealing.
+			AUTOMATIC = 0x04		// The game made this move on its own as a result of the move before it.
+		};
+
+		Move()
+		{
+			this->type = Type::MOVE_CARDS;
+			this->sourcePile = 0;
+			this->targetPile = 0;
+			this->cardCount = 0;
+			this->flags = 0;
+		}
+
+		Move(Type type, int sourcePile, int targetPile, int cardCount, uint8_t flags = 0)
+		{
+			this->type = type;
+			this->sourcePile = uint8_t(sourcePile);
+			this->targetPile = uint8_t(targetPile);
+			this->cardCount = uint8_t(cardCount);
+			this->flags = flags;
+		}
+
+		Type type;
+		uint8_t sourcePile;
+		uint8_t targetPile;
+		uint8_t cardCount;
+		uint8_t flags;
+	};
+
+	// A game reports every move made through it by the player (or by the game
+	// itself in reaction to the player) to its listener, if it has one.
+	class MoveListener
+	{
+	public:
+		virtual ~MoveListener() {}
+
+		virtual void OnMoveCommitted(SolitaireGame* game, const Move& move) = 0;
+
+		// Games never take moves back on their own, but an undo history that passes its moves on may.
+		virtual void OnMoveUndone(SolitaireGame* /*game*/, const Move& /*move*/) {}
+	};
+
 	class CardPile
 	{
 	public:
 		CardPile();
 		virtual ~CardPile();
 
-		virtual std::shared_ptr<CardPile> AllocNew() const = 0;
-		virtual std::shared_ptr<CardPile> Clone() const;
-		virtual void GenerateRenderList(std::vector<const Card*>& cardRenderList) const = 0;
+		virtual std::shared_ptr<CardPile> Clone() const = 0;
+		virtual void GenerateRenderList(std::vector<RenderItem>& renderList) const = 0;
 		virtual void LayoutCards(const Box& cardSize) = 0;
 
 		bool CardsInOrder(int start, int finish) const;
@@ -103,11 +336,44 @@ public:
 		bool CardsSameSuit(int start, int finish) const;
 		bool CardsAlternateColor(int start, int finish) const;
 		bool IndexValid(int i) const;
-		bool ContainsPoint(DirectX::XMVECTOR point, const Box& cardSize) const;
 
-		std::vector<std::shared_ptr<Card>> cardArray;
-		DirectX::XMVECTOR position;
-		std::shared_ptr<Card> emptyCard;
+		// The pile counts its cards in flight as they take off, land, come and go, so
+		// that asking whether any are is free and a pile at rest is never touched.
+		bool IsAnimating() const;
+		void Tick(double deltaTimeSeconds);
+
+		// The card is sent from the given place to where the pile last laid it out.
+		void StartAnimation(int cardOffset, const Vector2D& startPosition, double animationRate);
+		bool ContainsPoint(Vector2D point, const Box& cardSize) const;
+		Box GetBounds(const Box& cardSize) const;
+
+		// This is the offset of the top-most card under the given point, or -1 if there's none.
+		// The piles work it out from how they lay out their cards, unless any are animating.
+		virtual int CardIndexAtPoint(const Vector2D& point, const Box& cardSize) const;
+
+		void AddCard(const Card& card);
+		void AddCard(const Card& card, const CardVisual& visual);
+		Card RemoveCard();
+		void MoveCardsTo(CardPile* targetPile, int start);
+		void ClearCards();
+
+		// This lays the cards out again only if cards have come or gone or the pile has been moved since
+		// it last did, as otherwise they're already where they belong.  LayoutCards() always does it.
+		void UpdateLayout(const Box& cardSize);
+		bool NeedsLayout() const;
+
+		// This moves the pile and all of its cards together, which keeps them laid out.
+		void Translate(const Vector2D& delta);
+
+		// The visual array always runs parallel to the card array.
+		std::vector<Card> cardArray;
+		std::vector<CardVisual> visualArray;
+		Vector2D position;
+
+	private:
+		bool layoutNeeded;
+		Vector2D layoutPosition;
+		int animatingCardCount;
 	};
 
 	class CascadingCardPile : public CardPile
@@ -123,10 +389,13 @@ public:
 		CascadingCardPile(CascadeDirection cascadeDirection, int cascadeNumber);
 		virtual ~CascadingCardPile();
 
-		virtual std::shared_ptr<CardPile> AllocNew() const override;
 		virtual std::shared_ptr<CardPile> Clone() const override;
-		virtual void GenerateRenderList(std::vector<const Card*>& cardRenderList) const override;
+		virtual void GenerateRenderList(std::vector<RenderItem>& renderList) const override;
 		virtual void LayoutCards(const Box& cardSize) override;
+		virtual int CardIndexAtPoint(const Vector2D& point, const Box& cardSize) const override;
+
+		// This is how far each card is laid out from the one beneath it, once they start to cascade.
+		Vector2D GetCascadeDelta(const Box& cardSize) const;
 
 		CascadeDirection cascadeDirection;
 		int cascadeNumber;
@@ -138,30 +407,75 @@ public:
 		SingularCardPile();
 		virtual ~SingularCardPile();
 
-		virtual std::shared_ptr<CardPile> AllocNew() const override;
 		virtual std::shared_ptr<CardPile> Clone() const override;
-		virtual void GenerateRenderList(std::vector<const Card*>& cardRenderList) const override;
+		virtual void GenerateRenderList(std::vector<RenderItem>& renderList) const override;
 		virtual void LayoutCards(const Box& cardSize) override;
+		virtual int CardIndexAtPoint(const Vector2D& point, const Box& cardSize) const override;
 	};
 
 protected:
 
-	static void GenerateDeck(std::vector<std::shared_ptr<Card>>& cardArray);
-	static void SuffleCards(std::vector<std::shared_ptr<Card>>& cardArray);
-	static int RandomInteger(int min, int max);
+	static void GenerateDeck(std::vector<Card>& cardArray);
+	void SuffleCards(std::vector<Card>& cardArray);
+	int RandomInteger(int min, int max);
+	static bool CardGoesOnSuitPile(const Card& card, const CardPile* suitPile);
+
+	// The keys are made by mixing what they stand for rather than looked up in a table,
+	// so any pile, offset and card has one, and they're the same on every platform.
+	static uint64_t CardKey(int pileIndex, int cardOffset, const Card& card);
+	static uint64_t StockKey(int stockCount);
+
+	// These toggle cards in and out of the hash, so must be called for every card once
+	// before it changes (or leaves its pile) and once after (or on joining a pile.)
+	void HashCards(int pileIndex, int firstOffset, int cardCount);
+	void TurnTopCard(int pileIndex, Card::Orientation orientation);
 
-	bool FindCardInPile(DirectX::XMVECTOR worldPoint, std::shared_ptr<CardPile> givenCardPile, int& foundCardOffset);
-	bool FindCardAndPile(DirectX::XMVECTOR worldPoint, std::shared_ptr<CardPile>& foundCardPile, int& foundCardOffset);
-	bool FindEmptyPile(DirectX::XMVECTOR worldPoint, std::shared_ptr<CardPile>& foundCardPile);
+	virtual int GetStockCount() const;
 
-	void StartCardMoving(std::shared_ptr<CardPile> cardPile, int grabOffset, DirectX::XMVECTOR grabPoint);
-	void FinishCardMoving(std::shared_ptr<CardPile> targetPile, bool commitMove);
-	void ManageCardMoving(DirectX::XMVECTOR grabPoint);
+	// A variant holding cards outside of its piles writes and reads those after the piles.
+	virtual void SaveCards(std::vector<uint8_t>& byteArray) const;
+	virtual bool LoadCards(const uint8_t*& data, const uint8_t* dataEnd);
+	static void WriteCards(const std::vector<Card>& cardArray, std::vector<uint8_t>& byteArray);
+	static bool ReadCards(const uint8_t*& data, const uint8_t* dataEnd, std::vector<Card>& cardArray);
 
+	// These are the rules of the game, shared by the mouse handlers and GenerateMoves().
+	// If the cards at a given offset can't be picked up, then nor can any beneath them.
+	virtual bool CanPickUpCards(int pileIndex, int cardOffset) const = 0;
+	virtual bool CanPlaceCards(const Card& card, int cardCount, int pileIndex) const = 0;
+
+	CardPile* EditPile(int pileIndex);
+
+	bool FindCardInPile(Vector2D worldPoint, int pileIndex, int& foundCardOffset) const;
+	bool FindCardAndPile(Vector2D worldPoint, int& foundPileIndex, int& foundCardOffset) const;
+	bool FindEmptyPile(Vector2D worldPoint, int& foundPileIndex) const;
+
+	void UpdatePileGrid() const;
+
+	void StartCardMoving(int pileIndex, int grabOffset, Vector2D grabPoint);
+	void FinishCardMoving(int targetPileIndex, bool commitMove);
+	void ManageCardMoving(Vector2D grabPoint);
+	void CommitMove(const Move& move);
+
+	// These are all the piles on the table, the tableau piles coming first.  A pile
+	// may be shared with snapshots of the game made by Clone(), so a pile must only
+	// ever be modified through the pointer returned by EditPile().
 	std::vector<std::shared_ptr<CardPile>> cardPileArray;
+	int tableauPileCount;
 	std::shared_ptr<CardPile> movingCardPile;
 	Box cardSize;
 	Box worldExtents;
-	DirectX::XMVECTOR grabDelta;
-	std::shared_ptr<CardPile> originCardPile;
+	Vector2D grabDelta;
+	int originPileIndex;
+	MoveListener* moveListener;
+	Random random;
+	uint64_t hash;
+
+	// Every pile is entered in this grid by the box around all of its cards, or its place-holder
+	// if it's empty, so that the Find functions look at only the piles near the point.  A pile is
+	// entered again the next time the grid is used after it's been handed out by EditPile(), as
+	// that's the only way its cards can have moved, and the whole grid is entered again if the
+	// piles themselves change.
+	mutable SpatialGrid pileGrid;
+	mutable std::vector<bool> pileGridStaleArray;
+	mutable std::vector<SpatialGrid::Entry> pileHitArray;
 };
\ No newline at end of file
@@ -1,6 +1,5 @@
 #include "FreeCellSolitaireGame.h"
-
-using namespace DirectX;
+#include <assert.h>
 
 FreeCellSolitaireGame::FreeCellSolitaireGame(const Box& worldExtents, const Box& cardSize) : SolitaireGame(worldExtents, cardSize)
 {
@@ -15,30 +14,21 @@ FreeCellSolitaireGame::FreeCellSolitaireGame(const Box& worldExtents, const Box&
 	return std::make_shared<FreeCellSolitaireGame>(this->worldExtents, this->cardSize);
 }
 
-/*virtual*/ std::shared_ptr<SolitaireGame> FreeCellSolitaireGame::Clone() const
-{
-	auto game = SolitaireGame::Clone();
-
-	auto freeCell = dynamic_cast<FreeCellSolitaireGame*>(game.get());
-
-	for (const auto& cardPile : this->suitPileArray)
-		freeCell->suitPileArray.push_back(cardPile->Clone());
-
-	for (const auto& cardPile : this->freePileArray)
-		freeCell->freePileArray.push_back(cardPile->Clone());
-
-	return game;
-}
-
-/*virtual*/ void FreeCellSolitaireGame::NewGame()
+/*virtual*/ void FreeCellSolitaireGame::NewGame(uint64_t seed)
 {
 	this->Clear();
+	this->random.SetSeed(seed);
 
-	std::vector<std::shared_ptr<Card>> cardArray;
-	this->GenerateDeck(cardArray);
-	this->SuffleCards(cardArray);
+	std::vector<Card> cardArray;
+	if (seed >= FIRST_NUMBERED_DEAL && seed <= LAST_NUMBERED_DEAL)
+		this->GenerateNumberedDeal(seed, cardArray);
+	else
+	{
+		this->GenerateDeck(cardArray);
+		this->SuffleCards(cardArray);
+	}
 
-	int numPiles = 8;
+	int numPiles = NUM_CASCADE_PILES;
 	int numCards = (int)cardArray.size();
 	for (int i = 0; i < numCards; i++)
 	{
@@ -47,88 +37,62 @@ FreeCellSolitaireGame::FreeCellSolitaireGame(const Box& worldExtents, const Box&
 			auto pile = std::make_shared<CascadingCardPile>();
 			this->cardPileArray.push_back(pile);
 
-			pile->position = XMVectorSet(
-				(float(i) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth()),
-				this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 2.4f,
-				0.0f,
-				1.0f);
+			pile->position = Vector2D(
+				float((float(i) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth())),
+				float(this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 2.4f));
 		}
 
 		CardPile* pile = this->cardPileArray[i % numPiles].get();
-		std::shared_ptr<Card> card = cardArray.back();
+		Card card = cardArray.back();
 		cardArray.pop_back();
-		pile->cardArray.push_back(card);
-		card->orientation = Card::Orientation::FACE_UP;
+		card.SetOrientation(Card::Orientation::FACE_UP);
+		pile->AddCard(card);
 	}
 
 	for (std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
-		cardPile->LayoutCards(this->cardSize);
+		cardPile->UpdateLayout(this->cardSize);
+
+	this->tableauPileCount = NUM_CASCADE_PILES;
 
+	// The free cells go on the left and the suit piles on the right.
 	for (int i = 0; i < numPiles; i++)
 	{
 		auto pile = std::make_shared<SingularCardPile>();
+		this->cardPileArray.push_back(pile);
 
-		if (i < int(Card::Suit::NUM_SUITS))
-			this->freePileArray.push_back(pile);
-		else
-			this->suitPileArray.push_back(pile);
-
-		pile->position = XMVectorSet(
-			(float(i) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth()),
-			this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 1.2f,
-			0.0f,
-			1.0f);
-		pile->LayoutCards(this->cardSize);
+		pile->position = Vector2D(
+			float((float(i) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth())),
+			float(this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 1.2f));
+		pile->UpdateLayout(this->cardSize);
 	}
-}
-
-/*virtual*/ void FreeCellSolitaireGame::Clear()
-{
-	SolitaireGame::Clear();
-	this->suitPileArray.clear();
-	this->freePileArray.clear();
-}
 
-/*virtual*/ void FreeCellSolitaireGame::GenerateRenderList(std::vector<const Card*>& cardRenderList) const
-{
-	for (const std::shared_ptr<CardPile>& cardPile : this->suitPileArray)
-		cardPile->GenerateRenderList(cardRenderList);
-
-	for (const std::shared_ptr<CardPile>& cardPile : this->freePileArray)
-		cardPile->GenerateRenderList(cardRenderList);
+	assert(this->cardPileArray.size() == NUM_PILES);
 
-	SolitaireGame::GenerateRenderList(cardRenderList);
+	this->hash = this->CalcHash();
 }
 
-/*virtual*/ bool FreeCellSolitaireGame::OnMouseGrabAt(DirectX::XMVECTOR worldPoint)
+/*virtual*/ bool FreeCellSolitaireGame::OnMouseGrabAt(Vector2D worldPoint)
 {
 	assert(this->movingCardPile.get() == nullptr);
 
 	int foundCardOffset = -1;
-	std::shared_ptr<CardPile> foundCardPile;
-	if (this->FindCardAndPile(worldPoint, foundCardPile, foundCardOffset))
+	int foundPileIndex = -1;
+	if (this->FindCardAndPile(worldPoint, foundPileIndex, foundCardOffset))
 	{
-		Card* card = foundCardPile->cardArray[foundCardOffset].get();
-		if(foundCardPile->CardsInOrder(foundCardOffset, int(foundCardPile->cardArray.size()) - 1) &&
-			foundCardPile->CardsAlternateColor(foundCardOffset, int(foundCardPile->cardArray.size()) - 1))
+		if (this->CanPickUpCards(foundPileIndex, foundCardOffset))
 		{
-			int moveCardCount = int(foundCardPile->cardArray.size()) - foundCardOffset;
-			int freeCellCount = this->GetFreeCellCount();
-			if (moveCardCount <= freeCellCount + 1)
-			{
-				this->StartCardMoving(foundCardPile, foundCardOffset, worldPoint);
-				return true;
-			}
+			this->StartCardMoving(foundPileIndex, foundCardOffset, worldPoint);
+			return true;
 		}
 	}
 	else
 	{
-		for (int i = 0; i < int(this->freePileArray.size()); i++)
+		for (int i = FIRST_FREE_PILE; i < FIRST_FREE_PILE + NUM_FREE_PILES; i++)
 		{
-			std::shared_ptr<CardPile>& freePile = this->freePileArray[i];
-			if (freePile->ContainsPoint(worldPoint, this->cardSize) && freePile->cardArray.size() == 1)
+			const CardPile* freePile = this->cardPileArray[i].get();
+			if (freePile->ContainsPoint(worldPoint, this->cardSize) && this->CanPickUpCards(i, 0))
 			{
-				this->StartCardMoving(freePile, 0, worldPoint);
+				this->StartCardMoving(i, 0, worldPoint);
 				return true;
 			}
 		}
@@ -137,77 +101,94 @@ FreeCellSolitaireGame::FreeCellSolitaireGame(const Box& worldExtents, const Box&
 	return false;
 }
 
-/*virtual*/ bool FreeCellSolitaireGame::OnMouseReleaseAt(DirectX::XMVECTOR worldPoint)
+/*virtual*/ bool FreeCellSolitaireGame::OnMouseReleaseAt(Vector2D worldPoint)
 {
 	if (!this->movingCardPile.get())
 		return false;
+
+	Card card = this->movingCardPile->cardArray[0];
+	int cardCount = int(this->movingCardPile->cardArray.size());
 	
 	bool moveCards = false;
-	std::shared_ptr<CardPile> foundCardPile;
+	int foundPileIndex = -1;
 	int foundCardOffset = -1;
-	if (this->FindCardAndPile(worldPoint, foundCardPile, foundCardOffset))
+	if (this->FindCardAndPile(worldPoint, foundPileIndex, foundCardOffset))
 	{
-		const Card* card = foundCardPile->cardArray[foundCardOffset].get();
-		if (card->GetColor() != this->movingCardPile->cardArray[0]->GetColor() &&
-			int(card->value) - 1 == int(this->movingCardPile->cardArray[0]->value))
-		{
-			moveCards = true;
-		}
+		moveCards = this->CanPlaceCards(card, cardCount, foundPileIndex);
 	}
-	else if (this->movingCardPile->cardArray.size() == 1)
+	else
 	{
-		for (int i = 0; i < int(Card::Suit::NUM_SUITS); i++)
+		for (int i = FIRST_SUIT_PILE; i < FIRST_SUIT_PILE + NUM_SUIT_PILES; i++)
 		{
-			std::shared_ptr<CardPile>& suitPile = this->suitPileArray[i];
-			if (suitPile->ContainsPoint(worldPoint, this->cardSize))
+			if (this->cardPileArray[i]->ContainsPoint(worldPoint, this->cardSize) && this->CanPlaceCards(card, cardCount, i))
 			{
-				if (suitPile->cardArray.size() == 0 && this->movingCardPile->cardArray[0]->value == Card::Value::ACE ||
-					(int(suitPile->cardArray[suitPile->cardArray.size() - 1]->value) + 1 == int(this->movingCardPile->cardArray[0]->value) &&
-						suitPile->cardArray[suitPile->cardArray.size() - 1]->suit == this->movingCardPile->cardArray[0]->suit))
-				{
-					foundCardPile = suitPile;
-					moveCards = true;
-					break;
-				}
+				foundPileIndex = i;
+				moveCards = true;
+				break;
 			}
 		}
 
 		if (!moveCards)
 		{
-			for (int i = 0; i < int(this->freePileArray.size()); i++)
+			for (int i = FIRST_FREE_PILE; i < FIRST_FREE_PILE + NUM_FREE_PILES; i++)
 			{
-				std::shared_ptr<CardPile>& freePile = this->freePileArray[i];
-				if (freePile->ContainsPoint(worldPoint, this->cardSize))
+				if (this->cardPileArray[i]->ContainsPoint(worldPoint, this->cardSize) && this->CanPlaceCards(card, cardCount, i))
 				{
-					if (freePile->cardArray.size() == 0)
-					{
-						foundCardPile = freePile;
-						moveCards = true;
-						break;
-					}
+					foundPileIndex = i;
+					moveCards = true;
+					break;
 				}
 			}
 		}
 	}
 		
 	if (!moveCards)
-	{
-		for (std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
-		{
-			if (cardPile->cardArray.size() == 0 && cardPile->ContainsPoint(worldPoint, this->cardSize))
-			{
-				foundCardPile = cardPile;
-				moveCards = true;
-				break;
-			}
-		}
-	}
+		moveCards = this->FindEmptyPile(worldPoint, foundPileIndex);
 
-	this->FinishCardMoving(foundCardPile, moveCards);
+	this->FinishCardMoving(foundPileIndex, moveCards);
 	return moveCards;
 }
 
-/*virtual*/ void FreeCellSolitaireGame::OnMouseMove(DirectX::XMVECTOR worldPoint)
+/*virtual*/ bool FreeCellSolitaireGame::CanPickUpCards(int pileIndex, int cardOffset) const
+{
+	const CardPile* cardPile = this->cardPileArray[pileIndex].get();
+	if (!cardPile->IndexValid(cardOffset))
+		return false;
+
+	// Cards never come back off of the suit piles.
+	if (pileIndex >= FIRST_SUIT_PILE)
+		return false;
+
+	if (pileIndex >= FIRST_FREE_PILE)
+		return true;
+
+	int finish = int(cardPile->cardArray.size()) - 1;
+	if (!cardPile->CardsInOrder(cardOffset, finish) || !cardPile->CardsAlternateColor(cardOffset, finish))
+		return false;
+
+	// A run can only be moved as far as there are free cells to shuffle it through.
+	int moveCardCount = finish - cardOffset + 1;
+	return moveCardCount <= this->GetFreeCellCount() + 1;
+}
+
+/*virtual*/ bool FreeCellSolitaireGame::CanPlaceCards(const Card& card, int cardCount, int pileIndex) const
+{
+	const CardPile* cardPile = this->cardPileArray[pileIndex].get();
+
+	if (pileIndex >= FIRST_SUIT_PILE)
+		return cardCount == 1 && this->CardGoesOnSuitPile(card, cardPile);
+
+	if (pileIndex >= FIRST_FREE_PILE)
+		return cardCount == 1 && cardPile->cardArray.size() == 0;
+
+	if (cardPile->cardArray.size() == 0)
+		return true;
+
+	Card topCard = cardPile->cardArray.back();
+	return topCard.GetColor() != card.GetColor() && int(topCard.GetValue()) - 1 == int(card.GetValue());
+}
+
+/*virtual*/ void FreeCellSolitaireGame::OnMouseMove(Vector2D worldPoint)
 {
 	this->ManageCardMoving(worldPoint);
 }
@@ -227,18 +208,50 @@ FreeCellSolitaireGame::FreeCellSolitaireGame(const Box& worldExtents, const Box&
 
 /*virtual*/ bool FreeCellSolitaireGame::GameWon() const
 {
-	for (const std::shared_ptr<CardPile>& suitPile : this->suitPileArray)
-		if (suitPile->cardArray.size() < Card::Value::NUM_VALUES)
+	for (int i = FIRST_SUIT_PILE; i < FIRST_SUIT_PILE + NUM_SUIT_PILES; i++)
+		if (this->cardPileArray[i]->cardArray.size() < Card::Value::NUM_VALUES)
 			return false;
 
 	return true;
 }
 
+/*static*/ void FreeCellSolitaireGame::GenerateNumberedDeal(uint64_t dealNumber, std::vector<Card>& cardArray)
+{
+	// The deck starts out ace to king with the suits in the order below, and the cards
+	// are dealt row by row, each one picked by the C runtime's rand() of the time.
+	static const Card::Suit suitArray[] = { Card::Suit::CLUBS, Card::Suit::DIAMONDS, Card::Suit::HEARTS, Card::Suit::SPADES };
+
+	std::vector<Card> deckArray;
+	for (int i = 0; i < int(Card::NUM_VALUES) * int(Card::NUM_SUITS); i++)
+		deckArray.push_back(Card(Card::Value(i / int(Card::NUM_SUITS)), suitArray[i % int(Card::NUM_SUITS)]));
+
+	// The extended range reuses the first 2^32 seeds, with the top bit of each random
+	// number set beyond deal 2^31, and with one added to it beyond deal 2^32.
+	uint64_t state = (dealNumber < 0x100000000ull) ? dealNumber : (dealNumber - 0x100000000ull);
+
+	// We deal from the back of the array.
+	int cardCount = int(deckArray.size());
+	cardArray.resize(cardCount);
+	for (int i = 0; i < int(cardArray.size()); i++)
+	{
+		state = (state * 214013 + 2531011) & 0x7FFFFFFF;
+		uint32_t number = uint32_t(state >> 16);
+		if (dealNumber >= 0x100000000ull)
+			number += 1;
+		else if (dealNumber >= 0x80000000ull)
+			number |= 0x8000;
+
+		int j = int(number % uint32_t(cardCount));
+		cardArray[cardArray.size() - 1 - i] = deckArray[j];
+		deckArray[j] = deckArray[--cardCount];
+	}
+}
+
 int FreeCellSolitaireGame::GetFreeCellCount() const
 {
 	int count = 0;
-	for (const std::shared_ptr<CardPile>& freePile : this->freePileArray)
-		if (freePile->cardArray.size() == 0)
+	for (int i = FIRST_FREE_PILE; i < FIRST_FREE_PILE + NUM_FREE_PILES; i++)
+		if (this->cardPileArray[i]->cardArray.size() == 0)
 			count++;
 
 	return count;
@@ -8,22 +8,43 @@ public:
 	FreeCellSolitaireGame(const Box& worldExtents, const Box& cardSize);
 	virtual ~FreeCellSolitaireGame();
 
+	// This is how the piles are laid out in the pile array.
+	enum
+	{
+		NUM_CASCADE_PILES = 8,
+		NUM_FREE_PILES = 4,
+		NUM_SUIT_PILES = 4,
+		FIRST_FREE_PILE = NUM_CASCADE_PILES,
+		FIRST_SUIT_PILE = FIRST_FREE_PILE + NUM_FREE_PILES,
+		NUM_PILES = FIRST_SUIT_PILE + NUM_SUIT_PILES
+	};
+
+	// Seeds from 1 to 8589934591 deal the numbered games of the Microsoft versions
+	// of FreeCell, the classic deals being those up to 2147483647.  Other seeds are
+	// shuffled the same way as in the other variants.
+	enum : uint64_t
+	{
+		FIRST_NUMBERED_DEAL = 1,
+		LAST_NUMBERED_DEAL = 0x1FFFFFFFFull
+	};
+
 	virtual std::shared_ptr<SolitaireGame> AllocNew() const override;
-	virtual std::shared_ptr<SolitaireGame> Clone() const override;
-	virtual void NewGame() override;
-	virtual void Clear() override;
-	virtual void GenerateRenderList(std::vector<const Card*>& cardRenderList) const override;
-	virtual bool OnMouseGrabAt(DirectX::XMVECTOR worldPoint) override;
-	virtual bool OnMouseReleaseAt(DirectX::XMVECTOR worldPoint) override;
-	virtual void OnMouseMove(DirectX::XMVECTOR worldPoint) override;
+	virtual void NewGame(uint64_t seed) override;
+	using SolitaireGame::NewGame;
+	virtual bool OnMouseGrabAt(Vector2D worldPoint) override;
+	virtual bool OnMouseReleaseAt(Vector2D worldPoint) override;
+	virtual void OnMouseMove(Vector2D worldPoint) override;
 	virtual bool OnCardsNeeded() override;
 	virtual void OnKeyUp(uint32_t keyCode) override;
 	virtual void Tick(double deltaTimeSeconds) override;
 	virtual bool GameWon() const override;
 
+protected:
+	virtual bool CanPickUpCards(int pileIndex, int cardOffset) const override;
+	virtual bool CanPlaceCards(const Card& card, int cardCount, int pileIndex) const override;
+
 private:
 	int GetFreeCellCount() const;
 
-	std::vector<std::shared_ptr<CardPile>> suitPileArray;
-	std::vector<std::shared_ptr<CardPile>> freePileArray;
+	static void GenerateNumberedDeal(uint64_t dealNumber, std::vector<Card>& cardArray);
 };
\ No newline at end of file
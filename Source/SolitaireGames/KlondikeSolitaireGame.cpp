@@ -1,6 +1,5 @@
 #include "KlondikeSolitaireGame.h"
-
-using namespace DirectX;
+#include <assert.h>
 
 KlondikeSolitaireGame::KlondikeSolitaireGame(const Box& worldExtents, const Box& cardSize) : SolitaireGame(worldExtents, cardSize)
 {
@@ -21,39 +20,20 @@ KlondikeSolitaireGame::KlondikeSolitaireGame(const Box& worldExtents, const Box&
 
 	auto klondike = dynamic_cast<KlondikeSolitaireGame*>(game.get());
 
-	for (const auto& card : this->cardList)
-		klondike->cardList.push_back(card->Clone());
-
-	for (const auto& cardPile : this->suitPileArray)
-		klondike->suitPileArray.push_back(cardPile->Clone());
-
-	klondike->drawPile = this->drawPile->Clone();
+	klondike->cardArray = this->cardArray;
 
 	return game;
 }
 
-/*virtual*/ void KlondikeSolitaireGame::NewGame()
+/*virtual*/ void KlondikeSolitaireGame::NewGame(uint64_t seed)
 {
 	this->Clear();
+	this->random.SetSeed(seed);
 
-	std::vector<std::shared_ptr<Card>> cardArray;
-	this->GenerateDeck(cardArray);
-	this->SuffleCards(cardArray);
-
-	int numPiles = 7;
+	this->GenerateDeck(this->cardArray);
+	this->SuffleCards(this->cardArray);
 
-	for (int i = 0; i < int(Card::Suit::NUM_SUITS); i++)
-	{
-		auto pile = std::make_shared<SingularCardPile>();
-		this->suitPileArray.push_back(pile);
-
-		pile->position = XMVectorSet(
-			(float(i + 3) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth()),
-			this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 1.2f,
-			0.0f,
-			1.0f);
-		pile->LayoutCards(this->cardSize);
-	}
+	int numPiles = NUM_TABLEAU_PILES;
 
 	for (int i = 0; i < numPiles; i++)
 	{
@@ -62,81 +42,80 @@ KlondikeSolitaireGame::KlondikeSolitaireGame(const Box& worldExtents, const Box&
 
 		for (int j = 0; j <= i; j++)
 		{
-			std::shared_ptr<Card> card = cardArray.back();
-			card->orientation = (j == i) ? Card::Orientation::FACE_UP : Card::Orientation::FACE_DOWN;
-			cardArray.pop_back();
-			pile->cardArray.push_back(card);
+			Card card = this->cardArray.back();
+			card.SetOrientation((j == i) ? Card::Orientation::FACE_UP : Card::Orientation::FACE_DOWN);
+			this->cardArray.pop_back();
+			pile->AddCard(card);
 		}
 
-		pile->position = XMVectorSet(
-			(float(i) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth()),
-			this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 2.4f,
-			0.0f,
-			1.0f);
-		pile->LayoutCards(this->cardSize);
+		pile->position = Vector2D(
+			float((float(i) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth())),
+			float(this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 2.4f));
+		pile->UpdateLayout(this->cardSize);
 	}
 
-	this->drawPile = std::make_shared<CascadingCardPile>(CascadingCardPile::CascadeDirection::RIGHT, 3);
-	this->drawPile->position = XMVectorSet(
-		0.0f,
-		this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 1.2f,
+	this->tableauPileCount = NUM_TABLEAU_PILES;
+
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+	{
+		auto pile = std::make_shared<SingularCardPile>();
+		this->cardPileArray.push_back(pile);
+
+		pile->position = Vector2D(
+			float((float(i + 3) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth())),
+			float(this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 1.2f));
+		pile->UpdateLayout(this->cardSize);
+	}
+
+	auto drawPile = std::make_shared<CascadingCardPile>(CascadingCardPile::CascadeDirection::RIGHT, 3);
+	this->cardPileArray.push_back(drawPile);
+
+	drawPile->position = Vector2D(
 		0.0f,
-		1.0f);
-	this->drawPile->LayoutCards(this->cardSize);
+		float(this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 1.2f));
+	drawPile->UpdateLayout(this->cardSize);
 
-	for (std::shared_ptr<Card>& card : cardArray)
-		this->cardList.push_back(card);
+	assert(this->cardPileArray.size() == NUM_PILES);
+
+	this->hash = this->CalcHash();
 }
 
 /*virtual*/ void KlondikeSolitaireGame::Clear()
 {
 	SolitaireGame::Clear();
-	this->cardList.clear();
-	this->drawPile = nullptr;
-	this->suitPileArray.clear();
-}
-
-/*virtual*/ void KlondikeSolitaireGame::GenerateRenderList(std::vector<const Card*>& cardRenderList) const
-{
-	for (const std::shared_ptr<CardPile>& pile : this->suitPileArray)
-		pile->GenerateRenderList(cardRenderList);
-
-	this->drawPile->GenerateRenderList(cardRenderList);
-
-	SolitaireGame::GenerateRenderList(cardRenderList);
+	this->cardArray.clear();
 }
 
-/*virtual*/ bool KlondikeSolitaireGame::OnMouseGrabAt(DirectX::XMVECTOR worldPoint)
+/*virtual*/ bool KlondikeSolitaireGame::OnMouseGrabAt(Vector2D worldPoint)
 {
 	assert(this->movingCardPile.get() == nullptr);
 
 	int foundCardOffset = -1;
-	std::shared_ptr<CardPile> foundCardPile;
-	if (this->FindCardAndPile(worldPoint, foundCardPile, foundCardOffset))
+	int foundPileIndex = -1;
+	if (this->FindCardAndPile(worldPoint, foundPileIndex, foundCardOffset))
 	{
-		Card* card = foundCardPile->cardArray[foundCardOffset].get();
-		if (card->orientation == Card::Orientation::FACE_UP)
+		if (this->CanPickUpCards(foundPileIndex, foundCardOffset))
 		{
-			this->StartCardMoving(foundCardPile, foundCardOffset, worldPoint);
+			this->StartCardMoving(foundPileIndex, foundCardOffset, worldPoint);
 			return true;
 		}
 	}
-	else if(this->FindCardInPile(worldPoint, this->drawPile, foundCardOffset))
+	else if(this->FindCardInPile(worldPoint, DRAW_PILE, foundCardOffset))
 	{
-		if (foundCardOffset == int(this->drawPile->cardArray.size()) - 1)
+		if (this->CanPickUpCards(DRAW_PILE, foundCardOffset))
 		{
-			this->StartCardMoving(this->drawPile, foundCardOffset, worldPoint);
+			this->StartCardMoving(DRAW_PILE, foundCardOffset, worldPoint);
 			return true;
 		}
 	}
 	else
 	{
-		for (int i = 0; i < int(Card::Suit::NUM_SUITS); i++)
+		for (int i = FIRST_SUIT_PILE; i < FIRST_SUIT_PILE + NUM_SUIT_PILES; i++)
 		{
-			std::shared_ptr<CardPile>& suitPile = this->suitPileArray[i];
-			if (suitPile->ContainsPoint(worldPoint, this->cardSize) && suitPile->cardArray.size() > 0)
+			const CardPile* suitPile = this->cardPileArray[i].get();
+			if (suitPile->ContainsPoint(worldPoint, this->cardSize) && this->CanPickUpCards(i, int(suitPile->cardArray.size()) - 1))
 			{
-				this->StartCardMoving(suitPile, int(suitPile->cardArray.size()) - 1, worldPoint);
+				this->StartCardMoving(i, int(suitPile->cardArray.size()) - 1, worldPoint);
 				return true;
 			}
 		}
@@ -145,85 +124,231 @@ KlondikeSolitaireGame::KlondikeSolitaireGame(const Box& worldExtents, const Box&
 	return false;
 }
 
-/*virtual*/ bool KlondikeSolitaireGame::OnMouseReleaseAt(DirectX::XMVECTOR worldPoint)
+/*virtual*/ bool KlondikeSolitaireGame::OnMouseReleaseAt(Vector2D worldPoint)
 {
 	if (!this->movingCardPile.get())
 		return false;
 
+	Card card = this->movingCardPile->cardArray[0];
+	int cardCount = int(this->movingCardPile->cardArray.size());
+
 	bool moveCards = false;
-	std::shared_ptr<CardPile> foundCardPile;
+	int foundPileIndex = -1;
 	int foundCardOffset = -1;
-	if (this->FindCardAndPile(worldPoint, foundCardPile, foundCardOffset))
+	if (this->FindCardAndPile(worldPoint, foundPileIndex, foundCardOffset))
 	{
-		const Card* card = foundCardPile->cardArray[foundCardOffset].get();
-		if (card->GetColor() != this->movingCardPile->cardArray[0]->GetColor() &&
-			int(card->value) - 1 == int(this->movingCardPile->cardArray[0]->value))
-		{
-			moveCards = true;
-		}
+		moveCards = this->CanPlaceCards(card, cardCount, foundPileIndex);
 	}
-	else if (this->FindEmptyPile(worldPoint, foundCardPile))
+	else if (this->FindEmptyPile(worldPoint, foundPileIndex))
 	{
-		if (this->movingCardPile->cardArray[0]->value == Card::Value::KING)
-		{
-			moveCards = true;
-		}
+		moveCards = this->CanPlaceCards(card, cardCount, foundPileIndex);
 	}
-	else if(this->movingCardPile->cardArray.size() == 1)
+	else
 	{
-		for (int i = 0; i < int(Card::Suit::NUM_SUITS); i++)
+		for (int i = FIRST_SUIT_PILE; i < FIRST_SUIT_PILE + NUM_SUIT_PILES; i++)
 		{
-			std::shared_ptr<CardPile>& suitPile = this->suitPileArray[i];
-			if (suitPile->ContainsPoint(worldPoint, this->cardSize))
+			const CardPile* suitPile = this->cardPileArray[i].get();
+			if (suitPile->ContainsPoint(worldPoint, this->cardSize) && this->CanPlaceCards(card, cardCount, i))
 			{
-				if (suitPile->cardArray.size() == 0 && this->movingCardPile->cardArray[0]->value == Card::Value::ACE ||
-					suitPile->cardArray.size() > 0 &&
-					(int(suitPile->cardArray[suitPile->cardArray.size() - 1]->value) + 1 == int(this->movingCardPile->cardArray[0]->value) &&
-						suitPile->cardArray[suitPile->cardArray.size() - 1]->suit == this->movingCardPile->cardArray[0]->suit))
-				{
-					foundCardPile = suitPile;
-					moveCards = true;
-					break;
-				}
+				foundPileIndex = i;
+				moveCards = true;
+				break;
 			}
 		}
 	}
 
-	this->FinishCardMoving(foundCardPile, moveCards);
-	this->drawPile->LayoutCards(this->cardSize);
+	// Only the pile the cards came from needs laying out again, and that's done for us.
+	this->FinishCardMoving(foundPileIndex, moveCards);
 	return moveCards;
 }
 
-/*virtual*/ void KlondikeSolitaireGame::OnMouseMove(DirectX::XMVECTOR worldPoint)
+/*virtual*/ bool KlondikeSolitaireGame::CanPickUpCards(int pileIndex, int cardOffset) const
+{
+	const CardPile* cardPile = this->cardPileArray[pileIndex].get();
+	if (!cardPile->IndexValid(cardOffset))
+		return false;
+
+	// Any face-up card on the tableau can be picked up along with the cards on top of
+	// it, but only the top card of the draw pile or of a suit pile.
+	if (pileIndex < NUM_TABLEAU_PILES)
+		return cardPile->cardArray[cardOffset].GetOrientation() == Card::Orientation::FACE_UP;
+
+	return cardOffset == int(cardPile->cardArray.size()) - 1;
+}
+
+/*virtual*/ bool KlondikeSolitaireGame::CanPlaceCards(const Card& card, int cardCount, int pileIndex) const
+{
+	const CardPile* cardPile = this->cardPileArray[pileIndex].get();
+
+	if (pileIndex < NUM_TABLEAU_PILES)
+	{
+		if (cardPile->cardArray.size() == 0)
+			return card.GetValue() == Card::Value::KING;
+
+		Card topCard = cardPile->cardArray.back();
+		return topCard.GetColor() != card.GetColor() && int(topCard.GetValue()) - 1 == int(card.GetValue());
+	}
+
+	if (pileIndex < FIRST_SUIT_PILE + NUM_SUIT_PILES)
+		return cardCount == 1 && this->CardGoesOnSuitPile(card, cardPile);
+
+	return false;
+}
+
+/*virtual*/ void KlondikeSolitaireGame::GenerateMoves(std::vector<Move>& moveArray) const
+{
+	SolitaireGame::GenerateMoves(moveArray);
+
+	const CardPile* drawPile = this->cardPileArray[DRAW_PILE].get();
+
+	if (this->cardArray.size() > 0)
+		moveArray.push_back(Move(Move::Type::DEAL_CARDS, DRAW_PILE, DRAW_PILE, (this->cardArray.size() < 3) ? int(this->cardArray.size()) : 3));
+	else if (drawPile->cardArray.size() > 0)
+		moveArray.push_back(Move(Move::Type::DEAL_CARDS, DRAW_PILE, DRAW_PILE, (drawPile->cardArray.size() < 3) ? int(drawPile->cardArray.size()) : 3, Move::Flags::RECYCLED_STOCK));
+}
+
+/*virtual*/ void KlondikeSolitaireGame::OnMouseMove(Vector2D worldPoint)
 {
 	this->ManageCardMoving(worldPoint);
 }
 
 /*virtual*/ bool KlondikeSolitaireGame::OnCardsNeeded()
 {
-	if (this->cardList.size() == 0)
+	Move move(Move::Type::DEAL_CARDS, DRAW_PILE, DRAW_PILE, 0);
+	this->DealCards(move);
+	if (move.cardCount == 0)
+		return false;
+
+	this->CommitMove(move);
+	return true;
+}
+
+void KlondikeSolitaireGame::DealCards(Move& move)
+{
+	CardPile* drawPile = this->EditPile(DRAW_PILE);
+
+	this->hash ^= StockKey(int(this->cardArray.size()));
+
+	if (this->cardArray.size() == 0 && drawPile->cardArray.size() > 0)
 	{
-		while (this->drawPile->cardArray.size() > 0)
-		{
-			std::shared_ptr<Card> card = this->drawPile->cardArray.back();
-			this->drawPile->cardArray.pop_back();
-			this->cardList.push_back(card);
-		}
+		this->HashCards(DRAW_PILE, 0, int(drawPile->cardArray.size()));
+
+		while (drawPile->cardArray.size() > 0)
+			this->cardArray.push_back(drawPile->RemoveCard());
+
+		move.flags |= Move::Flags::RECYCLED_STOCK;
 	}
 	
+	int firstOffset = int(drawPile->cardArray.size());
 	for (int i = 0; i < 3; i++)
 	{
-		if (this->cardList.size() == 0)
+		if (this->cardArray.size() == 0)
 			break;
 
-		std::shared_ptr<Card> card = this->cardList.back();
-		this->cardList.pop_back();
-		this->drawPile->cardArray.push_back(card);
+		Card card = this->cardArray.back();
+		this->cardArray.pop_back();
+		drawPile->AddCard(card);
+		move.cardCount++;
+	}
+
+	this->HashCards(DRAW_PILE, firstOffset, int(drawPile->cardArray.size()) - firstOffset);
+	this->hash ^= StockKey(int(this->cardArray.size()));
+
+	drawPile->UpdateLayout(this->cardSize);
+}
+
+/*virtual*/ void KlondikeSolitaireGame::ApplyMove(const Move& move)
+{
+	if (move.type == Move::Type::DEAL_CARDS)
+	{
+		Move dealMove(Move::Type::DEAL_CARDS, DRAW_PILE, DRAW_PILE, 0);
+		this->DealCards(dealMove);
+		assert(dealMove.cardCount == move.cardCount);
+	}
+	else
+	{
+		SolitaireGame::ApplyMove(move);
 	}
+}
+
+/*virtual*/ void KlondikeSolitaireGame::UndoMove(const Move& move)
+{
+	if (move.type == Move::Type::DEAL_CARDS)
+	{
+		CardPile* drawPile = this->EditPile(DRAW_PILE);
+
+		this->hash ^= StockKey(int(this->cardArray.size()));
+		this->HashCards(DRAW_PILE, int(drawPile->cardArray.size()) - int(move.cardCount), int(move.cardCount));
+
+		for (int i = 0; i < int(move.cardCount); i++)
+			this->cardArray.push_back(drawPile->RemoveCard());
+
+		// Turning the stock back over restores the waste exactly as it was.
+		if ((move.flags & Move::Flags::RECYCLED_STOCK) != 0)
+		{
+			while (this->cardArray.size() > 0)
+			{
+				drawPile->AddCard(this->cardArray.back());
+				this->cardArray.pop_back();
+			}
+
+			this->HashCards(DRAW_PILE, 0, int(drawPile->cardArray.size()));
+		}
 
-	this->drawPile->LayoutCards(this->cardSize);
+		this->hash ^= StockKey(int(this->cardArray.size()));
+
+		drawPile->UpdateLayout(this->cardSize);
+	}
+	else
+	{
+		SolitaireGame::UndoMove(move);
+	}
+}
+
+/*virtual*/ bool KlondikeSolitaireGame::CanApplyMove(const Move& move) const
+{
+	if (move.type != Move::Type::DEAL_CARDS)
+		return SolitaireGame::CanApplyMove(move);
+
+	// Dealing turns over up to three cards, turning the waste back over first if the stock is out.
+	int stockCount = int(this->cardArray.size());
+	if (stockCount == 0)
+		stockCount = int(this->cardPileArray[DRAW_PILE]->cardArray.size());
+
+	int cardCount = (stockCount < 3) ? stockCount : 3;
+	return cardCount > 0 && int(move.cardCount) == cardCount;
+}
+
+/*virtual*/ bool KlondikeSolitaireGame::CanUndoMove(const Move& move) const
+{
+	if (move.type != Move::Type::DEAL_CARDS)
+		return SolitaireGame::CanUndoMove(move);
+
+	return move.cardCount > 0 && move.cardCount <= 3 && int(move.cardCount) <= int(this->cardPileArray[DRAW_PILE]->cardArray.size());
+}
+
+const std::vector<SolitaireGame::Card>& KlondikeSolitaireGame::GetStockCards() const
+{
+	return this->cardArray;
+}
+
+/*virtual*/ int KlondikeSolitaireGame::GetStockCount() const
+{
+	return int(this->cardArray.size());
+}
+
+/*virtual*/ void KlondikeSolitaireGame::SaveCards(std::vector<uint8_t>& byteArray) const
+{
+	SolitaireGame::SaveCards(byteArray);
+	WriteCards(this->cardArray, byteArray);
+}
+
+/*virtual*/ bool KlondikeSolitaireGame::LoadCards(const uint8_t*& data, const uint8_t* dataEnd)
+{
+	if (!SolitaireGame::LoadCards(data, dataEnd))
+		return false;
 
-	return this->drawPile->cardArray.size() > 0;
+	return ReadCards(data, dataEnd, this->cardArray);
 }
 
 /*virtual*/ void KlondikeSolitaireGame::OnKeyUp(uint32_t keyCode)
@@ -236,8 +361,8 @@ KlondikeSolitaireGame::KlondikeSolitaireGame(const Box& worldExtents, const Box&
 
 /*virtual*/ bool KlondikeSolitaireGame::GameWon() const
 {
-	for (const std::shared_ptr<CardPile>& suitPile : this->suitPileArray)
-		if (suitPile->cardArray.size() < Card::Value::NUM_VALUES)
+	for (int i = FIRST_SUIT_PILE; i < FIRST_SUIT_PILE + NUM_SUIT_PILES; i++)
+		if (this->cardPileArray[i]->cardArray.size() < Card::Value::NUM_VALUES)
 			return false;
 
 	return true;
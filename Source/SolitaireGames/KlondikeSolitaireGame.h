@@ -1,7 +1,6 @@
 #pragma once
 
 #include "SolitaireGame.h"
-#include <list>
 
 class KlondikeSolitaireGame : public SolitaireGame
 {
@@ -9,21 +8,46 @@ public:
 	KlondikeSolitaireGame(const Box& worldExtents, const Box& cardSize);
 	virtual ~KlondikeSolitaireGame();
 
+	// This is how the piles are laid out in the pile array.
+	enum
+	{
+		NUM_TABLEAU_PILES = 7,
+		NUM_SUIT_PILES = 4,
+		FIRST_SUIT_PILE = NUM_TABLEAU_PILES,
+		DRAW_PILE = FIRST_SUIT_PILE + NUM_SUIT_PILES,
+		NUM_PILES
+	};
+
 	virtual std::shared_ptr<SolitaireGame> AllocNew() const override;
 	virtual std::shared_ptr<SolitaireGame> Clone() const override;
-	virtual void NewGame() override;
+	virtual void NewGame(uint64_t seed) override;
+	using SolitaireGame::NewGame;
 	virtual void Clear() override;
-	virtual void GenerateRenderList(std::vector<const Card*>& cardRenderList) const override;
-	virtual bool OnMouseGrabAt(DirectX::XMVECTOR worldPoint) override;
-	virtual bool OnMouseReleaseAt(DirectX::XMVECTOR worldPoint) override;
-	virtual void OnMouseMove(DirectX::XMVECTOR worldPoint) override;
+	virtual bool OnMouseGrabAt(Vector2D worldPoint) override;
+	virtual bool OnMouseReleaseAt(Vector2D worldPoint) override;
+	virtual void OnMouseMove(Vector2D worldPoint) override;
 	virtual bool OnCardsNeeded() override;
 	virtual void OnKeyUp(uint32_t keyCode) override;
 	virtual void Tick(double deltaTimeSeconds) override;
 	virtual bool GameWon() const override;
+	virtual void GenerateMoves(std::vector<Move>& moveArray) const override;
+	virtual void ApplyMove(const Move& move) override;
+	virtual void UndoMove(const Move& move) override;
+	virtual bool CanApplyMove(const Move& move) const override;
+	virtual bool CanUndoMove(const Move& move) const override;
+
+	// These are the cards still to be dealt, the next one to be dealt last.
+	const std::vector<Card>& GetStockCards() const;
+
+protected:
+	virtual bool CanPickUpCards(int pileIndex, int cardOffset) const override;
+	virtual bool CanPlaceCards(const Card& card, int cardCount, int pileIndex) const override;
+	virtual int GetStockCount() const override;
+	virtual void SaveCards(std::vector<uint8_t>& byteArray) const override;
+	virtual bool LoadCards(const uint8_t*& data, const uint8_t* dataEnd) override;
 
 private:
-	std::list<std::shared_ptr<Card>> cardList;
-	std::shared_ptr<CardPile> drawPile;
-	std::vector<std::shared_ptr<CardPile>> suitPileArray;
+	void DealCards(Move& move);
+
+	std::vector<Card> cardArray;
 };
\ No newline at end of file
@@ -1,10 +1,9 @@
 #include "SpiderSolitaireGame.h"
-
-using namespace DirectX;
+#include <assert.h>
 
 SpiderSolitaireGame::SpiderSolitaireGame(const Box& worldExtents, const Box& cardSize, DifficultyLevel difficultyLevel) : SolitaireGame(worldExtents, cardSize)
 {
-	this->difficultyLevel = DifficultyLevel::LOW;
+	this->difficultyLevel = difficultyLevel;
 }
 
 /*virtual*/ SpiderSolitaireGame::~SpiderSolitaireGame()
@@ -20,25 +19,24 @@ SpiderSolitaireGame::SpiderSolitaireGame(const Box& worldExtents, const Box& car
 {
 	auto game = SolitaireGame::Clone();
 
-	assert(exitingCardArray.size() == 0);
-
 	auto spider = dynamic_cast<SpiderSolitaireGame*>(game.get());
 
-	for (const auto& card : this->cardArray)
-		spider->cardArray.push_back(card->Clone());
+	spider->cardArray = this->cardArray;
+	spider->removedCardArray = this->removedCardArray;
 
 	return game;
 }
 
-/*virtual*/ void SpiderSolitaireGame::NewGame()
+/*virtual*/ void SpiderSolitaireGame::NewGame(uint64_t seed)
 {
 	this->Clear();
+	this->random.SetSeed(seed);
 
 	this->GenerateDeck(this->cardArray);
 	this->GenerateDeck(this->cardArray);
 	this->SuffleCards(this->cardArray);
 
-	int numPiles = 10;
+	int numPiles = NUM_TABLEAU_PILES;
 
 	for (int i = 0; i < numPiles; i++)
 	{
@@ -47,50 +45,58 @@ SpiderSolitaireGame::SpiderSolitaireGame(const Box& worldExtents, const Box& car
 
 		for (int j = 0; j < ((i < 4) ? 6 : 5); j++)
 		{
-			std::shared_ptr<Card> card = this->cardArray.back();
-			card->orientation = Card::Orientation::FACE_DOWN;
+			Card card = this->cardArray.back();
+			card.SetOrientation(Card::Orientation::FACE_DOWN);
 			this->cardArray.pop_back();
-			pile->cardArray.push_back(card);
+			pile->AddCard(card);
 		}
 
-		pile->cardArray[pile->cardArray.size() - 1]->orientation = Card::Orientation::FACE_UP;
-		pile->position = XMVectorSet(
-			(float(i) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth()),
-			this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 1.2f,
-			0.0f,
-			1.0f);
-		pile->LayoutCards(this->cardSize);
+		pile->cardArray.back().SetOrientation(Card::Orientation::FACE_UP);
+		pile->position = Vector2D(
+			float((float(i) / float(numPiles - 1)) * (this->worldExtents.GetWidth() - this->cardSize.GetWidth())),
+			float(this->worldExtents.GetHeight() - this->cardSize.GetHeight() * 1.2f));
+		pile->UpdateLayout(this->cardSize);
 	}
+
+	this->tableauPileCount = NUM_TABLEAU_PILES;
+
+	this->hash = this->CalcHash();
 }
 
 /*virtual*/ void SpiderSolitaireGame::Clear()
 {
 	SolitaireGame::Clear();
 	this->cardArray.clear();
+	this->removedCardArray.clear();
+	this->exitingCardArray.clear();
+	this->exitingVisualArray.clear();
 }
 
-/*virtual*/ void SpiderSolitaireGame::GenerateRenderList(std::vector<const Card*>& cardRenderList) const
+/*virtual*/ void SpiderSolitaireGame::GenerateRenderList(std::vector<RenderItem>& renderList) const
 {
-	SolitaireGame::GenerateRenderList(cardRenderList);
+	SolitaireGame::GenerateRenderList(renderList);
 
-	for (const std::shared_ptr<Card>& card : this->exitingCardArray)
-		cardRenderList.push_back(card.get());
+	for (int i = 0; i < int(this->exitingCardArray.size()); i++)
+		renderList.push_back(RenderItem{ this->exitingCardArray[i], this->exitingVisualArray[i].position });
 }
 
 /*virtual*/ void SpiderSolitaireGame::Tick(double deltaTimeSeconds)
 {
 	SolitaireGame::Tick(deltaTimeSeconds);
 
-	int animationCount = 0;
-	for (std::shared_ptr<Card>& card : this->exitingCardArray)
+	size_t animationCount = 0;
+	for (CardVisual& visual : this->exitingVisualArray)
 	{
-		card->Tick(deltaTimeSeconds);
-		if (card->animationRate == 0.0)
+		visual.Tick(deltaTimeSeconds);
+		if (visual.animationRate == 0.0)
 			animationCount++;
 	}
 
-	if (animationCount == this->exitingCardArray.size())
+	if (animationCount == this->exitingVisualArray.size())
+	{
 		this->exitingCardArray.clear();
+		this->exitingVisualArray.clear();
+	}
 
 	// Note that we continuously check here for cards that can
 	// exit just so we don't have to think about checking for it
@@ -98,139 +104,346 @@ SpiderSolitaireGame::SpiderSolitaireGame(const Box& worldExtents, const Box& car
 	// A thought comes to mind.  The player may create a sequence
 	// that can exit, but maybe thay're not ready for it to exit?
 	// Would that ever be necessary or desired?
-	for (std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
+	for (int j = 0; j < int(this->cardPileArray.size()); j++)
 	{
-		if (cardPile->cardArray.size() < Card::Value::NUM_VALUES)
+		if (!this->CanRemoveCards(j))
 			continue;
 
-		if (cardPile->cardArray[cardPile->cardArray.size() - 1]->value != Card::Value::ACE)
-			continue;
+		// The run leaves the table in an animation that the rules know nothing about.
+		const CardPile* cardPile = this->cardPileArray[j].get();
+		for (int i = int(cardPile->cardArray.size()) - 1; i >= int(cardPile->cardArray.size()) - int(Card::Value::NUM_VALUES); i--)
+		{
+			CardVisual visual = cardPile->visualArray[i];
+			visual.targetPosition = this->worldExtents.max;
+			visual.animationRate = 200.0;
+			this->exitingCardArray.push_back(cardPile->cardArray[i]);
+			this->exitingVisualArray.push_back(visual);
+		}
 
-		int start = int(cardPile->cardArray.size()) - int(Card::Value::NUM_VALUES);
-		int finish = int(cardPile->cardArray.size()) - 1;
-		if (!cardPile->CardsInOrder(start, finish))
-			continue;
+		Move move(Move::Type::REMOVE_CARDS, j, j, int(Card::Value::NUM_VALUES), Move::Flags::AUTOMATIC);
+		this->RemoveCards(move);
+		this->CommitMove(move);
+	}
+}
 
-		bool exitCards = false;
-		if (this->difficultyLevel == DifficultyLevel::LOW)
-			exitCards = true;
-		else if (this->difficultyLevel == DifficultyLevel::MEDIUM)
-			exitCards = cardPile->CardsSameColor(start, finish);
-		else if (this->difficultyLevel == DifficultyLevel::HARD)
-			exitCards = cardPile->CardsSameSuit(start, finish);
+bool SpiderSolitaireGame::CardsFormRun(const CardPile* cardPile, int start, int finish) const
+{
+	if (!cardPile->CardsInOrder(start, finish))
+		return false;
 
-		if (exitCards)
-		{
-			for (int i = 0; i < int(Card::Value::NUM_VALUES); i++)
-			{
-				std::shared_ptr<Card> card = cardPile->cardArray.back();
-				cardPile->cardArray.pop_back();
-				card->targetPosition = this->worldExtents.max;
-				card->animationRate = 200.0;
-				this->exitingCardArray.push_back(card);
-			}
-
-			if (cardPile->cardArray.size() > 0)
-				cardPile->cardArray[cardPile->cardArray.size() - 1]->orientation = Card::Orientation::FACE_UP;
-		}
+	if (this->difficultyLevel == DifficultyLevel::MEDIUM)
+		return cardPile->CardsSameColor(start, finish);
+	else if (this->difficultyLevel == DifficultyLevel::HARD)
+		return cardPile->CardsSameSuit(start, finish);
+
+	return true;
+}
+
+bool SpiderSolitaireGame::CanRemoveCards(int pileIndex) const
+{
+	const CardPile* cardPile = this->cardPileArray[pileIndex].get();
+
+	if (cardPile->cardArray.size() < Card::Value::NUM_VALUES)
+		return false;
+
+	if (cardPile->cardArray.back().GetValue() != Card::Value::ACE)
+		return false;
+
+	int start = int(cardPile->cardArray.size()) - int(Card::Value::NUM_VALUES);
+	int finish = int(cardPile->cardArray.size()) - 1;
+	return this->CardsFormRun(cardPile, start, finish);
+}
+
+void SpiderSolitaireGame::RemoveCards(Move& move)
+{
+	CardPile* exitingPile = this->EditPile(move.sourcePile);
+
+	this->HashCards(move.sourcePile, int(exitingPile->cardArray.size()) - int(move.cardCount), int(move.cardCount));
+
+	for (int i = 0; i < int(move.cardCount); i++)
+		this->removedCardArray.push_back(exitingPile->RemoveCard());
+
+	if (exitingPile->cardArray.size() > 0 && exitingPile->cardArray.back().GetOrientation() == Card::Orientation::FACE_DOWN)
+	{
+		this->TurnTopCard(move.sourcePile, Card::Orientation::FACE_UP);
+		move.flags |= Move::Flags::FLIPPED_CARD;
 	}
 }
 
-/*virtual*/ bool SpiderSolitaireGame::OnMouseGrabAt(DirectX::XMVECTOR worldPoint)
+/*virtual*/ bool SpiderSolitaireGame::OnMouseGrabAt(Vector2D worldPoint)
 {
 	assert(this->movingCardPile.get() == nullptr);
 
-	std::shared_ptr<CardPile> foundCardPile;
+	int foundPileIndex = -1;
 	int foundCardOffset = -1;
-	if (this->FindCardAndPile(worldPoint, foundCardPile, foundCardOffset))
+	if (this->FindCardAndPile(worldPoint, foundPileIndex, foundCardOffset))
 	{
-		Card* card = foundCardPile->cardArray[foundCardOffset].get();
-		if (card->orientation == Card::Orientation::FACE_UP)
+		if (this->CanPickUpCards(foundPileIndex, foundCardOffset))
 		{
-			int start = foundCardOffset;
-			int finish = int(foundCardPile->cardArray.size()) - 1;
-			if (foundCardPile->CardsInOrder(start, finish))
-			{
-				bool canMoveCards = false;
-
-				if (this->difficultyLevel == DifficultyLevel::LOW)
-					canMoveCards = true;
-				else if (this->difficultyLevel == DifficultyLevel::MEDIUM)
-					canMoveCards = foundCardPile->CardsSameColor(start, finish);
-				else if (this->difficultyLevel == DifficultyLevel::HARD)
-					canMoveCards = foundCardPile->CardsSameSuit(start, finish);
-
-				if (canMoveCards)
-				{
-					this->StartCardMoving(foundCardPile, foundCardOffset, worldPoint);
-					return true;
-				}
-			}
+			this->StartCardMoving(foundPileIndex, foundCardOffset, worldPoint);
+			return true;
 		}
 	}
 
 	return false;
 }
 
-/*virtual*/ bool SpiderSolitaireGame::OnMouseReleaseAt(DirectX::XMVECTOR worldPoint)
+/*virtual*/ bool SpiderSolitaireGame::OnMouseReleaseAt(Vector2D worldPoint)
 {
 	if (!this->movingCardPile.get())
 		return false;
 	
 	bool moveCards = false;
-	std::shared_ptr<CardPile> foundCardPile;
+	int foundPileIndex = -1;
 	int foundCardOffset = -1;
-	if (this->FindCardAndPile(worldPoint, foundCardPile, foundCardOffset))
+	if (this->FindCardAndPile(worldPoint, foundPileIndex, foundCardOffset) || this->FindEmptyPile(worldPoint, foundPileIndex))
+		moveCards = this->CanPlaceCards(this->movingCardPile->cardArray[0], int(this->movingCardPile->cardArray.size()), foundPileIndex);
+
+	this->FinishCardMoving(foundPileIndex, moveCards);
+	return moveCards;
+}
+
+/*virtual*/ bool SpiderSolitaireGame::CanPickUpCards(int pileIndex, int cardOffset) const
+{
+	const CardPile* cardPile = this->cardPileArray[pileIndex].get();
+	if (!cardPile->IndexValid(cardOffset))
+		return false;
+
+	if (cardPile->cardArray[cardOffset].GetOrientation() != Card::Orientation::FACE_UP)
+		return false;
+
+	return this->CardsFormRun(cardPile, cardOffset, int(cardPile->cardArray.size()) - 1);
+}
+
+/*virtual*/ bool SpiderSolitaireGame::CanPlaceCards(const Card& card, int /*cardCount*/, int pileIndex) const
+{
+	const CardPile* cardPile = this->cardPileArray[pileIndex].get();
+	if (cardPile->cardArray.size() == 0)
+		return true;
+
+	return int(cardPile->cardArray.back().GetValue()) - 1 == int(card.GetValue());
+}
+
+/*virtual*/ void SpiderSolitaireGame::GenerateMoves(std::vector<Move>& moveArray) const
+{
+	SolitaireGame::GenerateMoves(moveArray);
+
+	if (this->CanDealCards())
+		moveArray.push_back(Move(Move::Type::DEAL_CARDS, 0, 0, (this->cardArray.size() < NUM_TABLEAU_PILES) ? int(this->cardArray.size()) : NUM_TABLEAU_PILES));
+
+	for (int i = 0; i < int(this->cardPileArray.size()); i++)
 	{
-		const Card* card = foundCardPile->cardArray[foundCardOffset].get();
-		if (foundCardOffset == foundCardPile->cardArray.size() - 1 &&
-			int(card->value) - 1 == int(this->movingCardPile->cardArray[0]->value))
+		if (this->CanRemoveCards(i))
 		{
-			moveCards = true;
+			const CardPile* cardPile = this->cardPileArray[i].get();
+			uint8_t flags = Move::Flags::AUTOMATIC;
+			int j = int(cardPile->cardArray.size()) - int(Card::Value::NUM_VALUES) - 1;
+			if (j >= 0 && cardPile->cardArray[j].GetOrientation() == Card::Orientation::FACE_DOWN)
+				flags |= Move::Flags::FLIPPED_CARD;
+
+			moveArray.push_back(Move(Move::Type::REMOVE_CARDS, i, i, int(Card::Value::NUM_VALUES), flags));
 		}
 	}
-	else if (this->FindEmptyPile(worldPoint, foundCardPile))
-	{
-		moveCards = true;
-	}
-
-	this->FinishCardMoving(foundCardPile, moveCards);
-	return moveCards;
 }
 
-/*virtual*/ void SpiderSolitaireGame::OnMouseMove(DirectX::XMVECTOR worldPoint)
+/*virtual*/ void SpiderSolitaireGame::OnMouseMove(Vector2D worldPoint)
 {
 	this->ManageCardMoving(worldPoint);
 }
 
 /*virtual*/ bool SpiderSolitaireGame::OnCardsNeeded()
+{
+	if (!this->CanDealCards())
+		return false;
+
+	int cardCount = this->DealCards();
+	if (cardCount == 0)
+		return false;
+
+	this->CommitMove(Move(Move::Type::DEAL_CARDS, 0, 0, cardCount));
+	return true;
+}
+
+bool SpiderSolitaireGame::CanDealCards() const
 {
 	// According to the rules of Spider, you can't deal out
 	// cards unless all 10 piles have at least one or more cards.
-	for (std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
+	for (const std::shared_ptr<CardPile>& cardPile : this->cardPileArray)
 		if (cardPile->cardArray.size() == 0)
 			return false;
 
+	return this->cardArray.size() > 0;
+}
+
+int SpiderSolitaireGame::DealCards()
+{
 	// Deal out 10 more cards or as many as we have left.
+	this->hash ^= StockKey(int(this->cardArray.size()));
+
 	int cardCount = 0;
-	for (int i = 0; i < 10 && this->cardArray.size() > 0; i++)
+	for (int i = 0; i < NUM_TABLEAU_PILES && this->cardArray.size() > 0; i++)
 	{
-		std::shared_ptr<Card> card = this->cardArray.back();
+		Card card = this->cardArray.back();
 		this->cardArray.pop_back();
 		cardCount++;
 		
-		card->orientation = Card::Orientation::FACE_UP;
+		card.SetOrientation(Card::Orientation::FACE_UP);
 
-		std::shared_ptr<CardPile>& cardPile = this->cardPileArray[i];
-		cardPile->cardArray.push_back(card);
-		cardPile->LayoutCards(this->cardSize);
+		CardPile* cardPile = this->EditPile(i);
+		cardPile->AddCard(card);
+		cardPile->UpdateLayout(this->cardSize);
+		this->HashCards(i, int(cardPile->cardArray.size()) - 1, 1);
 
-		card->targetPosition = card->position;
-		card->position = this->worldExtents.min;
-		card->animationRate = 200.0;
+		cardPile->StartAnimation(int(cardPile->cardArray.size()) - 1, this->worldExtents.min, 200.0);
 	}
 
-	return cardCount > 0;
+	this->hash ^= StockKey(int(this->cardArray.size()));
+
+	return cardCount;
+}
+
+/*virtual*/ void SpiderSolitaireGame::ApplyMove(const Move& move)
+{
+	if (move.type == Move::Type::DEAL_CARDS)
+	{
+		[[maybe_unused]] int cardCount = this->DealCards();
+		assert(cardCount == int(move.cardCount));
+	}
+	else if (move.type == Move::Type::REMOVE_CARDS)
+	{
+		Move removeMove(Move::Type::REMOVE_CARDS, move.sourcePile, move.targetPile, move.cardCount);
+		this->RemoveCards(removeMove);
+	}
+	else
+	{
+		SolitaireGame::ApplyMove(move);
+	}
+}
+
+/*virtual*/ void SpiderSolitaireGame::UndoMove(const Move& move)
+{
+	if (move.type == Move::Type::DEAL_CARDS)
+	{
+		// Pick the cards back up in the opposite order they were dealt.
+		this->hash ^= StockKey(int(this->cardArray.size()));
+
+		for (int i = int(move.cardCount) - 1; i >= 0; i--)
+		{
+			CardPile* cardPile = this->EditPile(i);
+			this->HashCards(i, int(cardPile->cardArray.size()) - 1, 1);
+			this->cardArray.push_back(cardPile->RemoveCard());
+			cardPile->UpdateLayout(this->cardSize);
+		}
+
+		this->hash ^= StockKey(int(this->cardArray.size()));
+	}
+	else if (move.type == Move::Type::REMOVE_CARDS)
+	{
+		CardPile* cardPile = this->EditPile(move.sourcePile);
+
+		if ((move.flags & Move::Flags::FLIPPED_CARD) != 0)
+			this->TurnTopCard(move.sourcePile, Card::Orientation::FACE_DOWN);
+
+		for (int i = 0; i < int(move.cardCount); i++)
+		{
+			cardPile->AddCard(this->removedCardArray.back());
+			this->removedCardArray.pop_back();
+		}
+
+		this->HashCards(move.sourcePile, int(cardPile->cardArray.size()) - int(move.cardCount), int(move.cardCount));
+
+		cardPile->UpdateLayout(this->cardSize);
+
+		// Whatever was still on its way off of the table doesn't get to finish.
+		this->exitingCardArray.clear();
+		this->exitingVisualArray.clear();
+	}
+	else
+	{
+		SolitaireGame::UndoMove(move);
+	}
+}
+
+/*virtual*/ bool SpiderSolitaireGame::CanApplyMove(const Move& move) const
+{
+	if (move.type == Move::Type::DEAL_CARDS)
+	{
+		int cardCount = (this->cardArray.size() < NUM_TABLEAU_PILES) ? int(this->cardArray.size()) : NUM_TABLEAU_PILES;
+		return cardCount > 0 && int(move.cardCount) == cardCount;
+	}
+
+	if (move.type == Move::Type::REMOVE_CARDS)
+	{
+		if (int(move.sourcePile) >= int(this->cardPileArray.size()) || move.cardCount != Card::Value::NUM_VALUES)
+			return false;
+
+		return this->CanRemoveCards(move.sourcePile);
+	}
+
+	return SolitaireGame::CanApplyMove(move);
+}
+
+/*virtual*/ bool SpiderSolitaireGame::CanUndoMove(const Move& move) const
+{
+	if (move.type == Move::Type::DEAL_CARDS)
+	{
+		if (move.cardCount == 0 || move.cardCount > NUM_TABLEAU_PILES)
+			return false;
+
+		// Each of the dealt cards is picked back up off of its own pile.
+		for (int i = 0; i < int(move.cardCount); i++)
+			if (this->cardPileArray[i]->cardArray.size() == 0)
+				return false;
+
+		return true;
+	}
+
+	if (move.type == Move::Type::REMOVE_CARDS)
+	{
+		if (int(move.sourcePile) >= int(this->cardPileArray.size()) || move.cardCount != Card::Value::NUM_VALUES)
+			return false;
+
+		if (int(move.cardCount) > int(this->removedCardArray.size()))
+			return false;
+
+		return (move.flags & Move::Flags::FLIPPED_CARD) == 0 || this->cardPileArray[move.sourcePile]->cardArray.size() > 0;
+	}
+
+	return SolitaireGame::CanUndoMove(move);
+}
+
+SpiderSolitaireGame::DifficultyLevel SpiderSolitaireGame::GetDifficultyLevel() const
+{
+	return this->difficultyLevel;
+}
+
+const std::vector<SolitaireGame::Card>& SpiderSolitaireGame::GetStockCards() const
+{
+	return this->cardArray;
+}
+
+/*virtual*/ int SpiderSolitaireGame::GetStockCount() const
+{
+	return int(this->cardArray.size());
+}
+
+/*virtual*/ void SpiderSolitaireGame::SaveCards(std::vector<uint8_t>& byteArray) const
+{
+	SolitaireGame::SaveCards(byteArray);
+	WriteCards(this->cardArray, byteArray);
+	WriteCards(this->removedCardArray, byteArray);
+}
+
+/*virtual*/ bool SpiderSolitaireGame::LoadCards(const uint8_t*& data, const uint8_t* dataEnd)
+{
+	if (!SolitaireGame::LoadCards(data, dataEnd))
+		return false;
+
+	// Cards still on their way off of the table are already among the removed cards.
+	this->exitingCardArray.clear();
+	this->exitingVisualArray.clear();
+
+	return ReadCards(data, dataEnd, this->cardArray) && ReadCards(data, dataEnd, this->removedCardArray);
 }
 
 /*virtual*/ void SpiderSolitaireGame::OnKeyUp(uint32_t keyCode)
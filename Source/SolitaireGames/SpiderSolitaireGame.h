@@ -12,24 +12,55 @@ public:
 		HARD
 	};
 
+	enum
+	{
+		NUM_TABLEAU_PILES = 10
+	};
+
 	SpiderSolitaireGame(const Box& worldExtents, const Box& cardSize, DifficultyLevel difficultyLevel);
 	virtual ~SpiderSolitaireGame();
 
 	virtual std::shared_ptr<SolitaireGame> AllocNew() const override;
 	virtual std::shared_ptr<SolitaireGame> Clone() const override;
-	virtual void NewGame() override;
+	virtual void NewGame(uint64_t seed) override;
+	using SolitaireGame::NewGame;
 	virtual void Clear() override;
-	virtual void GenerateRenderList(std::vector<const Card*>& cardRenderList) const override;
-	virtual bool OnMouseGrabAt(DirectX::XMVECTOR worldPoint) override;
-	virtual bool OnMouseReleaseAt(DirectX::XMVECTOR worldPoint) override;
-	virtual void OnMouseMove(DirectX::XMVECTOR worldPoint) override;
+	virtual void GenerateRenderList(std::vector<RenderItem>& renderList) const override;
+	virtual bool OnMouseGrabAt(Vector2D worldPoint) override;
+	virtual bool OnMouseReleaseAt(Vector2D worldPoint) override;
+	virtual void OnMouseMove(Vector2D worldPoint) override;
 	virtual bool OnCardsNeeded() override;
 	virtual void OnKeyUp(uint32_t keyCode) override;
 	virtual void Tick(double deltaTimeSeconds) override;
 	virtual bool GameWon() const override;
+	virtual void GenerateMoves(std::vector<Move>& moveArray) const override;
+	virtual void ApplyMove(const Move& move) override;
+	virtual void UndoMove(const Move& move) override;
+	virtual bool CanApplyMove(const Move& move) const override;
+	virtual bool CanUndoMove(const Move& move) const override;
+
+	DifficultyLevel GetDifficultyLevel() const;
+
+	// These are the cards still to be dealt, the next one to be dealt last.
+	const std::vector<Card>& GetStockCards() const;
+
+protected:
+	virtual bool CanPickUpCards(int pileIndex, int cardOffset) const override;
+	virtual bool CanPlaceCards(const Card& card, int cardCount, int pileIndex) const override;
+	virtual int GetStockCount() const override;
+	virtual void SaveCards(std::vector<uint8_t>& byteArray) const override;
+	virtual bool LoadCards(const uint8_t*& data, const uint8_t* dataEnd) override;
 
 private:
-	std::vector<std::shared_ptr<Card>> cardArray;
-	std::vector<std::shared_ptr<Card>> exitingCardArray;
+	bool CanDealCards() const;
+	bool CardsFormRun(const CardPile* cardPile, int start, int finish) const;
+	bool CanRemoveCards(int pileIndex) const;
+	int DealCards();
+	void RemoveCards(Move& move);
+
+	std::vector<Card> cardArray;
+	std::vector<Card> removedCardArray;
+	std::vector<Card> exitingCardArray;
+	std::vector<CardVisual> exitingVisualArray;
 	DifficultyLevel difficultyLevel;
 };
\ No newline at end of file
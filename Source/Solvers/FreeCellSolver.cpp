@@ -0,0 +1,441 @@
+#include "FreeCellSolver.h"
+#include <assert.h>
+#include <string.h>
+#include <queue>
+
+FreeCellSolver::FreeCellSolver()
+{
+	this->nodeLimit = 200000;
+
+	// Any fixed sequence of well mixed bits will do for the keys (this is splitmix64.)
+	uint64_t seed = 0;
+	for (int i = 0; i < NUM_CARDS; i++)
+	{
+		for (int j = 0; j < NUM_SUPPORTS; j++)
+		{
+			seed += 0x9E3779B97F4A7C15ull;
+			uint64_t key = seed;
+			key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+			key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+			this->keyTable[i][j] = key ^ (key >> 31);
+		}
+	}
+}
+
+/*virtual*/ FreeCellSolver::~FreeCellSolver()
+{
+}
+
+void FreeCellSolver::SetNodeLimit(int nodeLimit)
+{
+	this->nodeLimit = nodeLimit;
+}
+
+int FreeCellSolver::GetNodeCount() const
+{
+	return int(this->nodeArray.size());
+}
+
+FreeCellSolver::Result FreeCellSolver::Solve(const FreeCellSolitaireGame* game, std::vector<Move>& solution)
+{
+	solution.clear();
+
+	this->nodeArray.clear();
+	this->moveArray.clear();
+	this->visitedSet.clear();
+
+	Node rootNode;
+	if (!this->LoadState(game, rootNode.state))
+		return Result::GAVE_UP;
+
+	rootNode.parentIndex = -1;
+	rootNode.firstMove = 0;
+	this->AutoPlay(rootNode.state, this->moveArray);
+	rootNode.moveCount = int(this->moveArray.size());
+
+	this->nodeArray.push_back(rootNode);
+	this->visitedSet.insert(rootNode.state.hash);
+
+	std::priority_queue<QueueEntry> queue;
+	queue.push(QueueEntry{ this->Score(rootNode.state), 0 });
+
+	std::vector<Move> candidateArray;
+	int solvedNodeIndex = -1;
+
+	while (queue.size() > 0)
+	{
+		int nodeIndex = queue.top().nodeIndex;
+		queue.pop();
+
+		if (this->CountCardsHome(this->nodeArray[nodeIndex].state) == NUM_CARDS)
+		{
+			solvedNodeIndex = nodeIndex;
+			break;
+		}
+
+		if (int(this->nodeArray.size()) >= this->nodeLimit)
+			return Result::GAVE_UP;
+
+		candidateArray.clear();
+		this->GenerateMoves(this->nodeArray[nodeIndex].state, candidateArray);
+
+		for (const Move& move : candidateArray)
+		{
+			// Note that the node array may grow here, so the parent is re-fetched every time.
+			Node childNode;
+			childNode.state = this->nodeArray[nodeIndex].state;
+			childNode.parentIndex = nodeIndex;
+			childNode.firstMove = int(this->moveArray.size());
+
+			this->moveArray.push_back(move);
+			this->ApplyMove(childNode.state, move);
+			this->AutoPlay(childNode.state, this->moveArray);
+
+			if (!this->visitedSet.insert(childNode.state.hash).second)
+			{
+				this->moveArray.resize(childNode.firstMove);
+				continue;
+			}
+
+			childNode.moveCount = int(this->moveArray.size()) - childNode.firstMove;
+			this->nodeArray.push_back(childNode);
+			queue.push(QueueEntry{ this->Score(childNode.state), int(this->nodeArray.size()) - 1 });
+		}
+	}
+
+	if (solvedNodeIndex < 0)
+		return Result::UNSOLVABLE;
+
+	std::vector<int> pathArray;
+	for (int i = solvedNodeIndex; i >= 0; i = this->nodeArray[i].parentIndex)
+		pathArray.push_back(i);
+
+	for (int i = int(pathArray.size()) - 1; i >= 0; i--)
+	{
+		const Node& node = this->nodeArray[pathArray[i]];
+		for (int j = 0; j < node.moveCount; j++)
+			solution.push_back(this->moveArray[node.firstMove + j]);
+	}
+
+	return Result::SOLVED;
+}
+
+/*static*/ int FreeCellSolver::CardIndex(Card card)
+{
+	return int(card.GetSuit()) * int(Card::NUM_VALUES) + int(card.GetValue());
+}
+
+bool FreeCellSolver::LoadState(const FreeCellSolitaireGame* game, State& state) const
+{
+	if (game->GetPileCount() != FreeCellSolitaireGame::NUM_PILES)
+		return false;
+
+	state = State{};
+
+	for (int i = 0; i < NUM_CASCADE_PILES; i++)
+	{
+		const std::vector<Card>& cardArray = game->GetPile(i)->cardArray;
+		if (cardArray.size() > MAX_CASCADE_LENGTH)
+			return false;
+
+		for (int j = 0; j < int(cardArray.size()); j++)
+			state.cascade[i][j] = cardArray[j];
+
+		state.cascadeLength[i] = uint8_t(cardArray.size());
+	}
+
+	for (int i = 0; i < NUM_FREE_PILES; i++)
+	{
+		const std::vector<Card>& cardArray = game->GetPile(FIRST_FREE_PILE + i)->cardArray;
+		state.freeCell[i] = (cardArray.size() > 0) ? cardArray.back() : Card::Empty();
+	}
+
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+	{
+		const std::vector<Card>& cardArray = game->GetPile(FIRST_SUIT_PILE + i)->cardArray;
+		state.suitPile[i] = (cardArray.size() > 0) ? cardArray.back() : Card::Empty();
+	}
+
+	state.hash = this->CalcHash(state);
+	return true;
+}
+
+uint64_t FreeCellSolver::CascadeKey(const State& state, int cascade, int depth) const
+{
+	int support = (depth == 0) ? int(ON_EMPTY_CASCADE) : CardIndex(state.cascade[cascade][depth - 1]);
+	return this->keyTable[CardIndex(state.cascade[cascade][depth])][support];
+}
+
+uint64_t FreeCellSolver::CalcHash(const State& state) const
+{
+	uint64_t hash = 0;
+
+	for (int i = 0; i < NUM_CASCADE_PILES; i++)
+		for (int j = 0; j < int(state.cascadeLength[i]); j++)
+			hash ^= this->CascadeKey(state, i, j);
+
+	for (int i = 0; i < NUM_FREE_PILES; i++)
+		if (!state.freeCell[i].IsEmpty())
+			hash ^= this->keyTable[CardIndex(state.freeCell[i])][ON_FREE_CELL];
+
+	return hash;
+}
+
+void FreeCellSolver::ApplyMove(State& state, const Move& move) const
+{
+	int cardCount = int(move.cardCount);
+	Card cardArray[MAX_CASCADE_LENGTH];
+
+	// Only the bottom card of the moving cards changes what it rests on, so
+	// only its key needs to come out of and go back into the hash.
+	if (move.sourcePile < FIRST_FREE_PILE)
+	{
+		int start = int(state.cascadeLength[move.sourcePile]) - cardCount;
+		assert(start >= 0);
+		state.hash ^= this->CascadeKey(state, move.sourcePile, start);
+		::memcpy(cardArray, &state.cascade[move.sourcePile][start], cardCount * sizeof(Card));
+		state.cascadeLength[move.sourcePile] = uint8_t(start);
+	}
+	else
+	{
+		assert(move.sourcePile < FIRST_SUIT_PILE && cardCount == 1);
+		cardArray[0] = state.freeCell[move.sourcePile - FIRST_FREE_PILE];
+		state.hash ^= this->keyTable[CardIndex(cardArray[0])][ON_FREE_CELL];
+		state.freeCell[move.sourcePile - FIRST_FREE_PILE] = Card::Empty();
+	}
+
+	if (move.targetPile < FIRST_FREE_PILE)
+	{
+		int start = int(state.cascadeLength[move.targetPile]);
+		assert(start + cardCount <= MAX_CASCADE_LENGTH);
+		::memcpy(&state.cascade[move.targetPile][start], cardArray, cardCount * sizeof(Card));
+		state.cascadeLength[move.targetPile] = uint8_t(start + cardCount);
+		state.hash ^= this->CascadeKey(state, move.targetPile, start);
+	}
+	else if (move.targetPile < FIRST_SUIT_PILE)
+	{
+		state.freeCell[move.targetPile - FIRST_FREE_PILE] = cardArray[0];
+		state.hash ^= this->keyTable[CardIndex(cardArray[0])][ON_FREE_CELL];
+	}
+	else
+	{
+		state.suitPile[move.targetPile - FIRST_SUIT_PILE] = cardArray[0];
+	}
+}
+
+void FreeCellSolver::GenerateMoves(const State& state, std::vector<Move>& moveArray) const
+{
+	// Only the first of any empty free cells or empty cascades is ever a target,
+	// since moving to any of the others would lead to an equivalent position.
+	int firstFreeCell = -1;
+	int freeCellCount = 0;
+	for (int i = NUM_FREE_PILES - 1; i >= 0; i--)
+	{
+		if (state.freeCell[i].IsEmpty())
+		{
+			firstFreeCell = i;
+			freeCellCount++;
+		}
+	}
+
+	int firstEmptyCascade = -1;
+	for (int i = NUM_CASCADE_PILES - 1; i >= 0; i--)
+		if (state.cascadeLength[i] == 0)
+			firstEmptyCascade = i;
+
+	// This is the same limit the game puts on moving a run of cards.
+	int maxRunLength = freeCellCount + 1;
+
+	for (int i = 0; i < NUM_CASCADE_PILES; i++)
+	{
+		int length = int(state.cascadeLength[i]);
+		if (length == 0)
+			continue;
+
+		Card topCard = state.cascade[i][length - 1];
+
+		int suitPile = this->FindSuitPile(state, topCard);
+		if (suitPile >= 0)
+			moveArray.push_back(Move(Move::Type::MOVE_CARDS, i, FIRST_SUIT_PILE + suitPile, 1));
+
+		if (firstFreeCell >= 0)
+			moveArray.push_back(Move(Move::Type::MOVE_CARDS, i, FIRST_FREE_PILE + firstFreeCell, 1));
+
+		int runLength = 1;
+		while (runLength < length && runLength < maxRunLength)
+		{
+			Card upperCard = state.cascade[i][length - runLength];
+			Card lowerCard = state.cascade[i][length - runLength - 1];
+			if (lowerCard.GetColor() == upperCard.GetColor() || int(lowerCard.GetValue()) - 1 != int(upperCard.GetValue()))
+				break;
+
+			runLength++;
+		}
+
+		for (int j = 0; j < NUM_CASCADE_PILES; j++)
+		{
+			if (j == i)
+				continue;
+
+			int targetLength = int(state.cascadeLength[j]);
+			if (targetLength > 0)
+			{
+				// At most one card of the run can go on any given card.
+				Card targetCard = state.cascade[j][targetLength - 1];
+				int cardCount = int(targetCard.GetValue()) - int(topCard.GetValue());
+				if (1 <= cardCount && cardCount <= runLength)
+				{
+					Card card = state.cascade[i][length - cardCount];
+					if (card.GetColor() != targetCard.GetColor())
+						moveArray.push_back(Move(Move::Type::MOVE_CARDS, i, j, cardCount));
+				}
+			}
+			else if (j == firstEmptyCascade)
+			{
+				// Moving a whole cascade to an empty one gets nowhere.
+				for (int cardCount = 1; cardCount <= runLength && cardCount < length; cardCount++)
+					moveArray.push_back(Move(Move::Type::MOVE_CARDS, i, j, cardCount));
+			}
+		}
+	}
+
+	for (int i = 0; i < NUM_FREE_PILES; i++)
+	{
+		Card card = state.freeCell[i];
+		if (card.IsEmpty())
+			continue;
+
+		int suitPile = this->FindSuitPile(state, card);
+		if (suitPile >= 0)
+			moveArray.push_back(Move(Move::Type::MOVE_CARDS, FIRST_FREE_PILE + i, FIRST_SUIT_PILE + suitPile, 1));
+
+		for (int j = 0; j < NUM_CASCADE_PILES; j++)
+		{
+			int targetLength = int(state.cascadeLength[j]);
+			if (targetLength > 0)
+			{
+				Card targetCard = state.cascade[j][targetLength - 1];
+				if (targetCard.GetColor() != card.GetColor() && int(targetCard.GetValue()) - 1 == int(card.GetValue()))
+					moveArray.push_back(Move(Move::Type::MOVE_CARDS, FIRST_FREE_PILE + i, j, 1));
+			}
+			else if (j == firstEmptyCascade)
+			{
+				moveArray.push_back(Move(Move::Type::MOVE_CARDS, FIRST_FREE_PILE + i, j, 1));
+			}
+		}
+	}
+}
+
+void FreeCellSolver::AutoPlay(State& state, std::vector<Move>& moveArray) const
+{
+	bool playedCard = true;
+	while (playedCard)
+	{
+		playedCard = false;
+
+		for (int i = 0; i < NUM_CASCADE_PILES + NUM_FREE_PILES; i++)
+		{
+			Card card;
+			if (i < NUM_CASCADE_PILES)
+			{
+				if (state.cascadeLength[i] == 0)
+					continue;
+
+				card = state.cascade[i][state.cascadeLength[i] - 1];
+			}
+			else
+			{
+				card = state.freeCell[i - NUM_CASCADE_PILES];
+				if (card.IsEmpty())
+					continue;
+			}
+
+			int suitPile = this->FindSuitPile(state, card);
+			if (suitPile >= 0 && this->IsSafeToPlay(state, card))
+			{
+				Move move(Move::Type::MOVE_CARDS, i, FIRST_SUIT_PILE + suitPile, 1);
+				this->ApplyMove(state, move);
+				moveArray.push_back(move);
+				playedCard = true;
+			}
+		}
+	}
+}
+
+int FreeCellSolver::FindSuitPile(const State& state, Card card) const
+{
+	int emptyPile = -1;
+
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+	{
+		Card topCard = state.suitPile[i];
+		if (topCard.IsEmpty())
+		{
+			if (emptyPile < 0)
+				emptyPile = i;
+		}
+		else if (topCard.GetSuit() == card.GetSuit())
+		{
+			return (int(topCard.GetValue()) + 1 == int(card.GetValue())) ? i : -1;
+		}
+	}
+
+	return (card.GetValue() == Card::Value::ACE) ? emptyPile : -1;
+}
+
+bool FreeCellSolver::IsSafeToPlay(const State& state, Card card) const
+{
+	// A card is safe to play once no card of the opposite color that could go on it
+	// is still in play.  Aces and twos are always safe.
+	if (int(card.GetValue()) <= int(Card::Value::TWO))
+		return true;
+
+	int oppositeCount = 0;
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+	{
+		Card topCard = state.suitPile[i];
+		if (!topCard.IsEmpty() && topCard.GetColor() != card.GetColor() && int(topCard.GetValue()) >= int(card.GetValue()) - 1)
+			oppositeCount++;
+	}
+
+	return oppositeCount == 2;
+}
+
+int FreeCellSolver::CountCardsHome(const State& state) const
+{
+	int count = 0;
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+		if (!state.suitPile[i].IsEmpty())
+			count += int(state.suitPile[i].GetValue()) + 1;
+
+	return count;
+}
+
+int FreeCellSolver::Score(const State& state) const
+{
+	// Lower is better.  Cards still out count against a position, and more so for
+	// any card sitting on top of a lower card that will have to get out from under it.
+	int score = (NUM_CARDS - this->CountCardsHome(state)) * 6;
+
+	for (int i = 0; i < NUM_CASCADE_PILES; i++)
+	{
+		int lowestValue = int(Card::Value::NUM_VALUES);
+		for (int j = 0; j < int(state.cascadeLength[i]); j++)
+		{
+			int value = int(state.cascade[i][j].GetValue());
+			if (value > lowestValue)
+				score += 3;
+			else
+				lowestValue = value;
+		}
+
+		if (state.cascadeLength[i] == 0)
+			score -= 4;
+	}
+
+	for (int i = 0; i < NUM_FREE_PILES; i++)
+		if (!state.freeCell[i].IsEmpty())
+			score += 2;
+
+	return score;
+}
\ No newline at end of file
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "SolitaireGames/FreeCellSolitaireGame.h"
+#include <unordered_set>
+
+// This is a best-first search for a way to win a game of FreeCell from its current
+// position.  Positions that differ only in which free cell or which empty cascade
+// holds what hash the same, and cards that can't be needed on the tableau any more
+// are played to the suit piles automatically, which keeps the search small.
+class FreeCellSolver
+{
+public:
+	FreeCellSolver();
+	virtual ~FreeCellSolver();
+
+	enum Result
+	{
+		SOLVED,
+		UNSOLVABLE,
+		GAVE_UP
+	};
+
+	// When solved, the given moves can be passed in order to the game's ApplyMove() to win it.
+	Result Solve(const FreeCellSolitaireGame* game, std::vector<SolitaireGame::Move>& solution);
+
+	void SetNodeLimit(int nodeLimit);
+	int GetNodeCount() const;
+
+private:
+	typedef SolitaireGame::Card Card;
+	typedef SolitaireGame::Move Move;
+
+	enum
+	{
+		NUM_CASCADE_PILES = FreeCellSolitaireGame::NUM_CASCADE_PILES,
+		NUM_FREE_PILES = FreeCellSolitaireGame::NUM_FREE_PILES,
+		NUM_SUIT_PILES = FreeCellSolitaireGame::NUM_SUIT_PILES,
+		FIRST_FREE_PILE = FreeCellSolitaireGame::FIRST_FREE_PILE,
+		FIRST_SUIT_PILE = FreeCellSolitaireGame::FIRST_SUIT_PILE,
+		MAX_CASCADE_LENGTH = 20,
+		NUM_CARDS = int(Card::NUM_SUITS) * int(Card::NUM_VALUES)
+	};
+
+	// A card is hashed by what it rests on rather than by where it is, so that the
+	// order of the cascades and of the free cells doesn't change the hash.
+	enum
+	{
+		ON_FREE_CELL = NUM_CARDS,
+		ON_EMPTY_CASCADE,
+		NUM_SUPPORTS
+	};
+
+	// This mirrors the piles of the game, pile for pile.  Cards on the suit piles
+	// aren't hashed since they're implied by all the cards that aren't.
+	struct State
+	{
+		Card cascade[NUM_CASCADE_PILES][MAX_CASCADE_LENGTH];
+		uint8_t cascadeLength[NUM_CASCADE_PILES];
+		Card freeCell[NUM_FREE_PILES];
+		Card suitPile[NUM_SUIT_PILES];
+		uint64_t hash;
+	};
+
+	struct Node
+	{
+		State state;
+		int parentIndex;
+		int firstMove;
+		int moveCount;
+	};
+
+	struct QueueEntry
+	{
+		int score;
+		int nodeIndex;
+
+		bool operator<(const QueueEntry& entry) const
+		{
+			// The standard priority queue pops the greatest entry, so this is reversed.
+			if (this->score != entry.score)
+				return this->score > entry.score;
+
+			return this->nodeIndex < entry.nodeIndex;
+		}
+	};
+
+	static int CardIndex(Card card);
+
+	bool LoadState(const FreeCellSolitaireGame* game, State& state) const;
+	uint64_t CalcHash(const State& state) const;
+	uint64_t CascadeKey(const State& state, int cascade, int depth) const;
+	void ApplyMove(State& state, const Move& move) const;
+	void GenerateMoves(const State& state, std::vector<Move>& moveArray) const;
+	void AutoPlay(State& state, std::vector<Move>& moveArray) const;
+	int FindSuitPile(const State& state, Card card) const;
+	bool IsSafeToPlay(const State& state, Card card) const;
+	int CountCardsHome(const State& state) const;
+	int Score(const State& state) const;
+
+	uint64_t keyTable[NUM_CARDS][NUM_SUPPORTS];
+	std::vector<Node> nodeArray;
+	std::vector<Move> moveArray;
+	std::unordered_set<uint64_t> visitedSet;
+	int nodeLimit;
+};
\ No newline at end of file
@@ -0,0 +1,501 @@
+#include "KlondikeSolver.h"
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+KlondikeSolver::KlondikeSolver()
+{
+	this->nodeLimit = 1000000;
+	this->nodeCount = 0;
+	this->tableSizeLog2 = 20;
+
+	// Any fixed sequence of well mixed bits will do for the keys (this is splitmix64.)
+	uint64_t seed = 0;
+	for (int i = 0; i < 2 * NUM_CARDS * NUM_SUPPORTS + MAX_TALON_LENGTH + 1; i++)
+	{
+		seed += 0x9E3779B97F4A7C15ull;
+		uint64_t key = seed;
+		key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ull;
+		key = (key ^ (key >> 27)) * 0x94D049BB133111EBull;
+		key ^= key >> 31;
+
+		if (i < 2 * NUM_CARDS * NUM_SUPPORTS)
+			this->keyTable[i / NUM_SUPPORTS][i % NUM_SUPPORTS] = key;
+		else
+			this->wasteKeyTable[i - 2 * NUM_CARDS * NUM_SUPPORTS] = key;
+	}
+}
+
+/*virtual*/ KlondikeSolver::~KlondikeSolver()
+{
+}
+
+void KlondikeSolver::SetNodeLimit(int nodeLimit)
+{
+	this->nodeLimit = nodeLimit;
+}
+
+void KlondikeSolver::SetTableSize(int tableSizeLog2)
+{
+	this->tableSizeLog2 = tableSizeLog2;
+}
+
+int KlondikeSolver::GetNodeCount() const
+{
+	return this->nodeCount;
+}
+
+KlondikeSolver::Result KlondikeSolver::Solve(const KlondikeSolitaireGame* game, std::vector<Move>& solution)
+{
+	solution.clear();
+
+	this->nodeCount = 0;
+	this->pathArray.clear();
+	this->visitedTable.assign(size_t(1) << this->tableSizeLog2, 0);
+
+	struct Frame
+	{
+		State state;
+		int firstAction;
+		int actionCount;
+		int nextAction;
+		int pathLength;
+	};
+
+	std::vector<Frame> frameArray;
+	std::vector<Action> actionArray;
+
+	Frame rootFrame;
+	if (!this->LoadState(game, rootFrame.state))
+		return Result::GAVE_UP;
+
+	this->AutoPlay(rootFrame.state, this->pathArray);
+	if (this->CountCardsHome(rootFrame.state) == NUM_CARDS)
+	{
+		solution = this->pathArray;
+		return Result::SOLVED;
+	}
+
+	this->MarkVisited(this->PositionHash(rootFrame.state));
+
+	// The search is kept on an explicit stack since it can run very deep.
+	rootFrame.firstAction = 0;
+	this->GenerateActions(rootFrame.state, actionArray);
+	rootFrame.actionCount = int(actionArray.size());
+	rootFrame.nextAction = 0;
+	rootFrame.pathLength = int(this->pathArray.size());
+	frameArray.push_back(rootFrame);
+
+	while (frameArray.size() > 0)
+	{
+		Frame& frame = frameArray.back();
+		if (frame.nextAction == frame.actionCount)
+		{
+			actionArray.resize(frame.firstAction);
+			frameArray.pop_back();
+			continue;
+		}
+
+		Action action = actionArray[frame.firstAction + frame.nextAction++];
+
+		Frame childFrame;
+		childFrame.state = frame.state;
+		this->pathArray.resize(frame.pathLength);
+		this->ApplyAction(childFrame.state, action, this->pathArray);
+		this->AutoPlay(childFrame.state, this->pathArray);
+
+		if (this->CountCardsHome(childFrame.state) == NUM_CARDS)
+		{
+			solution = this->pathArray;
+			return Result::SOLVED;
+		}
+
+		if (!this->MarkVisited(this->PositionHash(childFrame.state)))
+			continue;
+
+		if (++this->nodeCount >= this->nodeLimit)
+			return Result::GAVE_UP;
+
+		childFrame.firstAction = int(actionArray.size());
+		this->GenerateActions(childFrame.state, actionArray);
+		childFrame.actionCount = int(actionArray.size()) - childFrame.firstAction;
+		childFrame.nextAction = 0;
+		childFrame.pathLength = int(this->pathArray.size());
+		frameArray.push_back(childFrame);
+	}
+
+	return Result::UNSOLVABLE;
+}
+
+/*static*/ int KlondikeSolver::CardIndex(Card card)
+{
+	return int(card.GetSuit()) * int(Card::NUM_VALUES) + int(card.GetValue());
+}
+
+bool KlondikeSolver::LoadState(const KlondikeSolitaireGame* game, State& state) const
+{
+	if (game->GetPileCount() != KlondikeSolitaireGame::NUM_PILES)
+		return false;
+
+	state = State{};
+
+	for (int i = 0; i < NUM_TABLEAU_PILES; i++)
+	{
+		const std::vector<Card>& cardArray = game->GetPile(i)->cardArray;
+		if (cardArray.size() > MAX_PILE_LENGTH)
+			return false;
+
+		for (int j = 0; j < int(cardArray.size()); j++)
+			state.pile[i][j] = cardArray[j];
+
+		state.pileLength[i] = uint8_t(cardArray.size());
+	}
+
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+	{
+		const std::vector<Card>& cardArray = game->GetPile(FIRST_SUIT_PILE + i)->cardArray;
+		state.suitPile[i] = (cardArray.size() > 0) ? cardArray.back() : Card::Empty();
+	}
+
+	const std::vector<Card>& drawArray = game->GetPile(DRAW_PILE)->cardArray;
+	const std::vector<Card>& stockArray = game->GetStockCards();
+	if (drawArray.size() + stockArray.size() > MAX_TALON_LENGTH)
+		return false;
+
+	for (int i = 0; i < int(drawArray.size()); i++)
+		state.talon[state.talonLength++] = drawArray[i];
+
+	for (int i = int(stockArray.size()) - 1; i >= 0; i--)
+		state.talon[state.talonLength++] = stockArray[i];
+
+	state.wasteCount = uint8_t(drawArray.size());
+	state.hash = this->CalcHash(state);
+	return true;
+}
+
+uint64_t KlondikeSolver::PileKey(const State& state, int pile, int depth) const
+{
+	Card card = state.pile[pile][depth];
+	int cardIndex = CardIndex(card) + ((card.GetOrientation() == Card::Orientation::FACE_DOWN) ? NUM_CARDS : 0);
+	int support = (depth == 0) ? int(ON_EMPTY_PILE) : CardIndex(state.pile[pile][depth - 1]);
+	return this->keyTable[cardIndex][support];
+}
+
+uint64_t KlondikeSolver::CalcHash(const State& state) const
+{
+	uint64_t hash = 0;
+
+	for (int i = 0; i < NUM_TABLEAU_PILES; i++)
+		for (int j = 0; j < int(state.pileLength[i]); j++)
+			hash ^= this->PileKey(state, i, j);
+
+	for (int i = 0; i < int(state.talonLength); i++)
+		hash ^= this->keyTable[CardIndex(state.talon[i])][IN_TALON];
+
+	return hash;
+}
+
+uint64_t KlondikeSolver::PositionHash(const State& state) const
+{
+	// Dealing three at a time forever cycles through every multiple of three turned
+	// over (and all of them turned over), so any of those are the same position.
+	int wasteCount = int(state.wasteCount);
+	if (wasteCount % 3 == 0 || wasteCount == int(state.talonLength))
+		wasteCount = 0;
+
+	return state.hash ^ this->wasteKeyTable[wasteCount];
+}
+
+int KlondikeSolver::NextWasteCount(const State& state, int wasteCount) const
+{
+	// This is what the game's OnCardsNeeded() does to the talon.
+	int talonLength = int(state.talonLength);
+	if (wasteCount == talonLength)
+		return (talonLength < 3) ? talonLength : 3;
+
+	return (wasteCount + 3 < talonLength) ? (wasteCount + 3) : talonLength;
+}
+
+void KlondikeSolver::ApplyAction(State& state, const Action& action, std::vector<Move>& moveArray) const
+{
+	const Move& move = action.move;
+	int cardCount = int(move.cardCount);
+	Card cardArray[MAX_PILE_LENGTH];
+
+	if (move.sourcePile == DRAW_PILE)
+	{
+		// Deal until the card is on top of the draw pile.
+		while (int(state.wasteCount) != action.wasteCount)
+		{
+			int wasteCount = this->NextWasteCount(state, state.wasteCount);
+			if (state.wasteCount == state.talonLength)
+				moveArray.push_back(Move(Move::Type::DEAL_CARDS, DRAW_PILE, DRAW_PILE, wasteCount, Move::Flags::RECYCLED_STOCK));
+			else
+				moveArray.push_back(Move(Move::Type::DEAL_CARDS, DRAW_PILE, DRAW_PILE, wasteCount - int(state.wasteCount)));
+
+			state.wasteCount = uint8_t(wasteCount);
+		}
+
+		int i = int(state.wasteCount) - 1;
+		cardArray[0] = state.talon[i];
+		state.hash ^= this->keyTable[CardIndex(cardArray[0])][IN_TALON];
+		::memmove(&state.talon[i], &state.talon[i + 1], (int(state.talonLength) - i - 1) * sizeof(Card));
+		state.talonLength--;
+		state.wasteCount--;
+	}
+	else if (move.sourcePile < NUM_TABLEAU_PILES)
+	{
+		// Only the bottom card of the moving cards changes what it rests on.
+		int start = int(state.pileLength[move.sourcePile]) - cardCount;
+		assert(start >= 0);
+		state.hash ^= this->PileKey(state, move.sourcePile, start);
+		::memcpy(cardArray, &state.pile[move.sourcePile][start], cardCount * sizeof(Card));
+		state.pileLength[move.sourcePile] = uint8_t(start);
+
+		if ((move.flags & Move::Flags::FLIPPED_CARD) != 0)
+		{
+			state.hash ^= this->PileKey(state, move.sourcePile, start - 1);
+			state.pile[move.sourcePile][start - 1].SetOrientation(Card::Orientation::FACE_UP);
+			state.hash ^= this->PileKey(state, move.sourcePile, start - 1);
+		}
+	}
+	else
+	{
+		Card& suitCard = state.suitPile[move.sourcePile - FIRST_SUIT_PILE];
+		cardArray[0] = suitCard;
+		if (suitCard.GetValue() == Card::Value::ACE)
+			suitCard = Card::Empty();
+		else
+			suitCard = Card(Card::Value(int(suitCard.GetValue()) - 1), suitCard.GetSuit());
+	}
+
+	if (move.targetPile < NUM_TABLEAU_PILES)
+	{
+		int start = int(state.pileLength[move.targetPile]);
+		assert(start + cardCount <= MAX_PILE_LENGTH);
+		::memcpy(&state.pile[move.targetPile][start], cardArray, cardCount * sizeof(Card));
+		state.pileLength[move.targetPile] = uint8_t(start + cardCount);
+		state.hash ^= this->PileKey(state, move.targetPile, start);
+	}
+	else
+	{
+		state.suitPile[move.targetPile - FIRST_SUIT_PILE] = cardArray[0];
+	}
+
+	moveArray.push_back(move);
+}
+
+void KlondikeSolver::GenerateActions(const State& state, std::vector<Action>& actionArray) const
+{
+	int firstAction = int(actionArray.size());
+
+	int firstEmptyPile = -1;
+	for (int i = NUM_TABLEAU_PILES - 1; i >= 0; i--)
+		if (state.pileLength[i] == 0)
+			firstEmptyPile = i;
+
+	for (int i = 0; i < NUM_TABLEAU_PILES; i++)
+	{
+		int length = int(state.pileLength[i]);
+		if (length == 0)
+			continue;
+
+		Card topCard = state.pile[i][length - 1];
+		uint8_t topFlags = (length > 1 && state.pile[i][length - 2].GetOrientation() == Card::Orientation::FACE_DOWN) ? Move::Flags::FLIPPED_CARD : 0;
+
+		int suitPile = this->FindSuitPile(state, topCard);
+		if (suitPile >= 0)
+			actionArray.push_back(Action{ Move(Move::Type::MOVE_CARDS, i, FIRST_SUIT_PILE + suitPile, 1, topFlags), 0, topFlags ? 6 : 5 });
+
+		int firstFaceUp = length - 1;
+		while (firstFaceUp > 0 && state.pile[i][firstFaceUp - 1].GetOrientation() == Card::Orientation::FACE_UP)
+			firstFaceUp--;
+
+		// Moving the whole run is worth trying, and so is moving part of it to free up a
+		// card for the suit piles, but there's no point in moving part of it otherwise.
+		for (int j = firstFaceUp; j < length; j++)
+		{
+			if (j > firstFaceUp && this->FindSuitPile(state, state.pile[i][j - 1]) < 0)
+				continue;
+
+			Card card = state.pile[i][j];
+			int cardCount = length - j;
+			uint8_t flags = (j > 0 && state.pile[i][j - 1].GetOrientation() == Card::Orientation::FACE_DOWN) ? Move::Flags::FLIPPED_CARD : 0;
+			int priority = flags ? 4 : 2;
+
+			for (int k = 0; k < NUM_TABLEAU_PILES; k++)
+			{
+				if (k == i)
+					continue;
+
+				int targetLength = int(state.pileLength[k]);
+				if (targetLength > 0)
+				{
+					Card targetCard = state.pile[k][targetLength - 1];
+					if (targetCard.GetColor() != card.GetColor() && int(targetCard.GetValue()) - 1 == int(card.GetValue()))
+						actionArray.push_back(Action{ Move(Move::Type::MOVE_CARDS, i, k, cardCount, flags), 0, priority });
+				}
+				else if (k == firstEmptyPile && j > 0 && card.GetValue() == Card::Value::KING)
+				{
+					actionArray.push_back(Action{ Move(Move::Type::MOVE_CARDS, i, k, cardCount, flags), 0, priority });
+				}
+			}
+		}
+	}
+
+	// Find every card that can be dealt to the top of the draw pile from here.
+	bool reachedArray[MAX_TALON_LENGTH + 1] = {};
+	int wasteCount = int(state.wasteCount);
+	reachedArray[wasteCount] = true;
+	while (true)
+	{
+		if (wasteCount > 0)
+		{
+			Card card = state.talon[wasteCount - 1];
+
+			int suitPile = this->FindSuitPile(state, card);
+			if (suitPile >= 0)
+				actionArray.push_back(Action{ Move(Move::Type::MOVE_CARDS, DRAW_PILE, FIRST_SUIT_PILE + suitPile, 1), wasteCount, 4 });
+
+			for (int k = 0; k < NUM_TABLEAU_PILES; k++)
+			{
+				int targetLength = int(state.pileLength[k]);
+				if (targetLength > 0)
+				{
+					Card targetCard = state.pile[k][targetLength - 1];
+					if (targetCard.GetColor() != card.GetColor() && int(targetCard.GetValue()) - 1 == int(card.GetValue()))
+						actionArray.push_back(Action{ Move(Move::Type::MOVE_CARDS, DRAW_PILE, k, 1), wasteCount, 3 });
+				}
+				else if (k == firstEmptyPile && card.GetValue() == Card::Value::KING)
+				{
+					actionArray.push_back(Action{ Move(Move::Type::MOVE_CARDS, DRAW_PILE, k, 1), wasteCount, 3 });
+				}
+			}
+		}
+
+		wasteCount = this->NextWasteCount(state, wasteCount);
+		if (reachedArray[wasteCount])
+			break;
+
+		reachedArray[wasteCount] = true;
+	}
+
+	// Taking a card back off of the suit piles is occasionally needed to make room.
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+	{
+		Card card = state.suitPile[i];
+		if (card.IsEmpty())
+			continue;
+
+		for (int k = 0; k < NUM_TABLEAU_PILES; k++)
+		{
+			int targetLength = int(state.pileLength[k]);
+			if (targetLength > 0)
+			{
+				Card targetCard = state.pile[k][targetLength - 1];
+				if (targetCard.GetColor() != card.GetColor() && int(targetCard.GetValue()) - 1 == int(card.GetValue()))
+					actionArray.push_back(Action{ Move(Move::Type::MOVE_CARDS, FIRST_SUIT_PILE + i, k, 1), 0, 1 });
+			}
+		}
+	}
+
+	std::stable_sort(actionArray.begin() + firstAction, actionArray.end(), [](const Action& actionA, const Action& actionB) {
+		return actionA.priority > actionB.priority;
+	});
+}
+
+void KlondikeSolver::AutoPlay(State& state, std::vector<Move>& moveArray) const
+{
+	bool playedCard = true;
+	while (playedCard)
+	{
+		playedCard = false;
+
+		for (int i = 0; i < NUM_TABLEAU_PILES; i++)
+		{
+			int length = int(state.pileLength[i]);
+			if (length == 0)
+				continue;
+
+			Card card = state.pile[i][length - 1];
+			int suitPile = this->FindSuitPile(state, card);
+			if (suitPile >= 0 && this->IsSafeToPlay(state, card))
+			{
+				uint8_t flags = (length > 1 && state.pile[i][length - 2].GetOrientation() == Card::Orientation::FACE_DOWN) ? Move::Flags::FLIPPED_CARD : 0;
+				this->ApplyAction(state, Action{ Move(Move::Type::MOVE_CARDS, i, FIRST_SUIT_PILE + suitPile, 1, flags), 0, 0 }, moveArray);
+				playedCard = true;
+			}
+		}
+
+		if (state.wasteCount > 0)
+		{
+			Card card = state.talon[state.wasteCount - 1];
+			int suitPile = this->FindSuitPile(state, card);
+			if (suitPile >= 0 && this->IsSafeToPlay(state, card))
+			{
+				this->ApplyAction(state, Action{ Move(Move::Type::MOVE_CARDS, DRAW_PILE, FIRST_SUIT_PILE + suitPile, 1), int(state.wasteCount), 0 }, moveArray);
+				playedCard = true;
+			}
+		}
+	}
+}
+
+int KlondikeSolver::FindSuitPile(const State& state, Card card) const
+{
+	int emptyPile = -1;
+
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+	{
+		Card topCard = state.suitPile[i];
+		if (topCard.IsEmpty())
+		{
+			if (emptyPile < 0)
+				emptyPile = i;
+		}
+		else if (topCard.GetSuit() == card.GetSuit())
+		{
+			return (int(topCard.GetValue()) + 1 == int(card.GetValue())) ? i : -1;
+		}
+	}
+
+	return (card.GetValue() == Card::Value::ACE) ? emptyPile : -1;
+}
+
+bool KlondikeSolver::IsSafeToPlay(const State& state, Card card) const
+{
+	// A card is safe to play once no card of the opposite color that could go on it
+	// is still in play.  Aces and twos are always safe.
+	if (int(card.GetValue()) <= int(Card::Value::TWO))
+		return true;
+
+	int oppositeCount = 0;
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+	{
+		Card topCard = state.suitPile[i];
+		if (!topCard.IsEmpty() && topCard.GetColor() != card.GetColor() && int(topCard.GetValue()) >= int(card.GetValue()) - 1)
+			oppositeCount++;
+	}
+
+	return oppositeCount == 2;
+}
+
+int KlondikeSolver::CountCardsHome(const State& state) const
+{
+	int count = 0;
+	for (int i = 0; i < NUM_SUIT_PILES; i++)
+		if (!state.suitPile[i].IsEmpty())
+			count += int(state.suitPile[i].GetValue()) + 1;
+
+	return count;
+}
+
+bool KlondikeSolver::MarkVisited(uint64_t hash)
+{
+	// A newer position simply replaces an older one that lands in the same slot.
+	uint64_t& entry = this->visitedTable[hash & (this->visitedTable.size() - 1)];
+	if (entry == hash)
+		return false;
+
+	entry = hash;
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "SolitaireGames/KlondikeSolitaireGame.h"
+
+// This is a depth-first search for a way to win a game of Klondike, seeing all of the
+// cards (what's known as thoughtful solitaire.)  The stock and draw pile are treated
+// as one sequence of cards along with how many of them are turned over, and a move
+// may play any card that dealing three at a time would eventually bring to the top.
+// Visited positions go in a fixed size table, so memory use doesn't grow with the
+// search, and the search gives up after a set number of positions.
+class KlondikeSolver
+{
+public:
+	KlondikeSolver();
+	virtual ~KlondikeSolver();
+
+	enum Result
+	{
+		SOLVED,
+		UNSOLVABLE,
+		GAVE_UP
+	};
+
+	// When solved, the given moves can be passed in order to the game's ApplyMove() to win it.
+	Result Solve(const KlondikeSolitaireGame* game, std::vector<SolitaireGame::Move>& solution);
+
+	void SetNodeLimit(int nodeLimit);
+	void SetTableSize(int tableSizeLog2);
+	int GetNodeCount() const;
+
+private:
+	typedef SolitaireGame::Card Card;
+	typedef SolitaireGame::Move Move;
+
+	enum
+	{
+		NUM_TABLEAU_PILES = KlondikeSolitaireGame::NUM_TABLEAU_PILES,
+		NUM_SUIT_PILES = KlondikeSolitaireGame::NUM_SUIT_PILES,
+		FIRST_SUIT_PILE = KlondikeSolitaireGame::FIRST_SUIT_PILE,
+		DRAW_PILE = KlondikeSolitaireGame::DRAW_PILE,
+		MAX_PILE_LENGTH = 20,
+		NUM_CARDS = int(Card::NUM_SUITS) * int(Card::NUM_VALUES),
+		MAX_TALON_LENGTH = 24
+	};
+
+	// As in the FreeCell solver, a card is hashed by what it rests on, which makes
+	// the hash blind to the order of the tableau piles.
+	enum
+	{
+		ON_EMPTY_PILE = NUM_CARDS,
+		IN_TALON,
+		NUM_SUPPORTS
+	};
+
+	// The talon holds the draw pile and then the stock, in the order they're dealt.
+	// The first wasteCount of these are the ones turned over into the draw pile.
+	struct State
+	{
+		Card pile[NUM_TABLEAU_PILES][MAX_PILE_LENGTH];
+		uint8_t pileLength[NUM_TABLEAU_PILES];
+		Card suitPile[NUM_SUIT_PILES];
+		Card talon[MAX_TALON_LENGTH];
+		uint8_t talonLength;
+		uint8_t wasteCount;
+		uint64_t hash;
+	};
+
+	// This is a move along with the number of cards that must be turned over
+	// to bring its card to the top of the draw pile, if it comes from there.
+	struct Action
+	{
+		Move move;
+		int wasteCount;
+		int priority;
+	};
+
+	static int CardIndex(Card card);
+
+	bool LoadState(const KlondikeSolitaireGame* game, State& state) const;
+	uint64_t PileKey(const State& state, int pile, int depth) const;
+	uint64_t CalcHash(const State& state) const;
+	uint64_t PositionHash(const State& state) const;
+	int NextWasteCount(const State& state, int wasteCount) const;
+	void ApplyAction(State& state, const Action& action, std::vector<Move>& moveArray) const;
+	void GenerateActions(const State& state, std::vector<Action>& actionArray) const;
+	void AutoPlay(State& state, std::vector<Move>& moveArray) const;
+	int FindSuitPile(const State& state, Card card) const;
+	bool IsSafeToPlay(const State& state, Card card) const;
+	int CountCardsHome(const State& state) const;
+	bool MarkVisited(uint64_t hash);
+	Result Search(const State& state);
+
+	uint64_t keyTable[2 * NUM_CARDS][NUM_SUPPORTS];
+	uint64_t wasteKeyTable[MAX_TALON_LENGTH + 1];
+	std::vector<uint64_t> visitedTable;
+	std::vector<Move> pathArray;
+	int tableSizeLog2;
+	int nodeLimit;
+	int nodeCount;
+};
\ No newline at end of file
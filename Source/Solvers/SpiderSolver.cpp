@@ -0,0 +1,383 @@
+#include "SpiderSolver.h"
+#include <assert.h>
+#include <string.h>
+#include <algorithm>
+
+SpiderSolver::SpiderSolver()
+{
+	this->difficultyLevel = SpiderSolitaireGame::DifficultyLevel::LOW;
+	this->nodeLimit = 1000000;
+	this->nodeCount = 0;
+}
+
+/*virtual*/ SpiderSolver::~SpiderSolver()
+{
+}
+
+void SpiderSolver::SetNodeLimit(int nodeLimit)
+{
+	this->nodeLimit = nodeLimit;
+}
+
+int SpiderSolver::GetNodeCount() const
+{
+	return this->nodeCount;
+}
+
+SpiderSolver::Result SpiderSolver::Solve(const SpiderSolitaireGame* game, std::vector<Move>& solution)
+{
+	solution.clear();
+
+	this->nodeCount = 0;
+
+	State rootState;
+	if (!this->LoadState(game, rootState))
+		return Result::GAVE_UP;
+
+	// Each pass searches twice as deep as the last, until one either finds a win or
+	// runs out of positions without ever having been cut short.  Wins take longer the
+	// fewer cards there are that build on each other, so the harder levels start deeper.
+	for (int depthLimit = INITIAL_DEPTH_LIMIT << int(this->difficultyLevel); depthLimit <= MAX_DEPTH_LIMIT; depthLimit *= 2)
+	{
+		switch (this->Search(rootState, depthLimit))
+		{
+		case SearchResult::FOUND:
+			solution = this->pathArray;
+			return Result::SOLVED;
+		case SearchResult::NOT_FOUND:
+			return Result::UNSOLVABLE;
+		case SearchResult::OUT_OF_NODES:
+			return Result::GAVE_UP;
+		case SearchResult::CUT_OFF:
+			break;
+		}
+	}
+
+	return Result::GAVE_UP;
+}
+
+SpiderSolver::SearchResult SpiderSolver::Search(const State& rootState, int depthLimit)
+{
+	struct Frame
+	{
+		State state;
+		int depth;
+		int firstAction;
+		int actionCount;
+		int nextAction;
+		int pathLength;
+	};
+
+	std::vector<Frame> frameArray;
+	std::vector<Action> actionArray;
+	bool cutOff = false;
+
+	this->visitedMap.clear();
+	this->pathArray.clear();
+
+	Frame rootFrame;
+	rootFrame.state = rootState;
+	this->RemoveRuns(rootFrame.state, this->pathArray);
+	if (rootFrame.state.removedCount == NUM_RUNS)
+		return SearchResult::FOUND;
+
+	this->visitedMap[this->CalcHash(rootFrame.state)] = 0;
+
+	rootFrame.depth = 0;
+	rootFrame.firstAction = 0;
+	this->GenerateActions(rootFrame.state, actionArray);
+	rootFrame.actionCount = int(actionArray.size());
+	rootFrame.nextAction = 0;
+	rootFrame.pathLength = int(this->pathArray.size());
+	frameArray.push_back(rootFrame);
+
+	while (frameArray.size() > 0)
+	{
+		Frame& frame = frameArray.back();
+		if (frame.nextAction == frame.actionCount)
+		{
+			actionArray.resize(frame.firstAction);
+			frameArray.pop_back();
+			continue;
+		}
+
+		const Move move = actionArray[frame.firstAction + frame.nextAction++].move;
+
+		Frame childFrame;
+		childFrame.state = frame.state;
+		childFrame.depth = frame.depth + 1;
+		this->pathArray.resize(frame.pathLength);
+		this->pathArray.push_back(move);
+		this->ApplyMove(childFrame.state, move);
+		this->RemoveRuns(childFrame.state, this->pathArray);
+
+		if (childFrame.state.removedCount == NUM_RUNS)
+			return SearchResult::FOUND;
+
+		// A position already reached in as few moves or fewer needn't be searched again.
+		uint64_t hash = this->CalcHash(childFrame.state);
+		auto iter = this->visitedMap.find(hash);
+		if (iter != this->visitedMap.end() && iter->second <= childFrame.depth)
+			continue;
+
+		this->visitedMap[hash] = childFrame.depth;
+
+		if (++this->nodeCount >= this->nodeLimit)
+			return SearchResult::OUT_OF_NODES;
+
+		if (childFrame.depth >= depthLimit)
+		{
+			cutOff = true;
+			continue;
+		}
+
+		childFrame.firstAction = int(actionArray.size());
+		this->GenerateActions(childFrame.state, actionArray);
+		childFrame.actionCount = int(actionArray.size()) - childFrame.firstAction;
+		childFrame.nextAction = 0;
+		childFrame.pathLength = int(this->pathArray.size());
+		frameArray.push_back(childFrame);
+	}
+
+	return cutOff ? SearchResult::CUT_OFF : SearchResult::NOT_FOUND;
+}
+
+bool SpiderSolver::LoadState(const SpiderSolitaireGame* game, State& state)
+{
+	if (game->GetPileCount() != NUM_TABLEAU_PILES)
+		return false;
+
+	state = State();
+
+	this->difficultyLevel = game->GetDifficultyLevel();
+	this->stockArray = game->GetStockCards();
+
+	int tableauCount = 0;
+	for (int i = 0; i < NUM_TABLEAU_PILES; i++)
+	{
+		const std::vector<Card>& cardArray = game->GetPile(i)->cardArray;
+		if (tableauCount + int(cardArray.size()) + int(this->stockArray.size()) > NUM_CARDS)
+			return false;
+
+		::memcpy(&state.cardArray[tableauCount], cardArray.data(), cardArray.size() * sizeof(Card));
+		state.pileLength[i] = uint8_t(cardArray.size());
+		tableauCount += int(cardArray.size());
+	}
+
+	state.stockCount = uint8_t(this->stockArray.size());
+	state.removedCount = uint8_t((NUM_CARDS - tableauCount - int(state.stockCount)) / int(Card::NUM_VALUES));
+	return true;
+}
+
+uint64_t SpiderSolver::CalcHash(const State& state) const
+{
+	// This is FNV-1a over the packed piles, their lengths and the size of the stock.
+	uint64_t hash = 0xCBF29CE484222325ull;
+
+	int cardCount = this->PileStart(state, NUM_TABLEAU_PILES);
+	for (int i = 0; i < cardCount; i++)
+		hash = (hash ^ state.cardArray[i].bits) * 0x100000001B3ull;
+
+	for (int i = 0; i < NUM_TABLEAU_PILES; i++)
+		hash = (hash ^ state.pileLength[i]) * 0x100000001B3ull;
+
+	return (hash ^ state.stockCount) * 0x100000001B3ull;
+}
+
+int SpiderSolver::PileStart(const State& state, int pile) const
+{
+	int start = 0;
+	for (int i = 0; i < pile; i++)
+		start += int(state.pileLength[i]);
+
+	return start;
+}
+
+SpiderSolver::Card SpiderSolver::TopCard(const State& state, int pile, int depth /*= 0*/) const
+{
+	return state.cardArray[this->PileStart(state, pile + 1) - 1 - depth];
+}
+
+bool SpiderSolver::CardsLink(Card lowerCard, Card upperCard) const
+{
+	// This is the game's test for cards that belong to the same run.
+	if (int(lowerCard.GetValue()) - 1 != int(upperCard.GetValue()))
+		return false;
+
+	if (this->difficultyLevel == SpiderSolitaireGame::DifficultyLevel::MEDIUM)
+		return lowerCard.GetColor() == upperCard.GetColor();
+	else if (this->difficultyLevel == SpiderSolitaireGame::DifficultyLevel::HARD)
+		return lowerCard.GetSuit() == upperCard.GetSuit();
+
+	return true;
+}
+
+int SpiderSolver::RunLength(const State& state, int pile) const
+{
+	int length = int(state.pileLength[pile]);
+	if (length == 0)
+		return 0;
+
+	int end = this->PileStart(state, pile + 1);
+	int runLength = 1;
+	while (runLength < length)
+	{
+		Card lowerCard = state.cardArray[end - runLength - 1];
+		Card upperCard = state.cardArray[end - runLength];
+		if (lowerCard.GetOrientation() == Card::Orientation::FACE_DOWN || !this->CardsLink(lowerCard, upperCard))
+			break;
+
+		runLength++;
+	}
+
+	return runLength;
+}
+
+void SpiderSolver::RemoveCards(State& state, int pile, int cardCount, Card* cardArray) const
+{
+	int end = this->PileStart(state, pile + 1);
+	int total = this->PileStart(state, NUM_TABLEAU_PILES);
+
+	::memcpy(cardArray, &state.cardArray[end - cardCount], cardCount * sizeof(Card));
+	::memmove(&state.cardArray[end - cardCount], &state.cardArray[end], (total - end) * sizeof(Card));
+	state.pileLength[pile] -= uint8_t(cardCount);
+}
+
+void SpiderSolver::AddCards(State& state, int pile, int cardCount, const Card* cardArray) const
+{
+	int end = this->PileStart(state, pile + 1);
+	int total = this->PileStart(state, NUM_TABLEAU_PILES);
+	assert(total + cardCount <= NUM_CARDS);
+
+	::memmove(&state.cardArray[end + cardCount], &state.cardArray[end], (total - end) * sizeof(Card));
+	::memcpy(&state.cardArray[end], cardArray, cardCount * sizeof(Card));
+	state.pileLength[pile] += uint8_t(cardCount);
+}
+
+void SpiderSolver::ApplyMove(State& state, const Move& move) const
+{
+	Card cardArray[NUM_CARDS];
+
+	switch (move.type)
+	{
+	case Move::Type::MOVE_CARDS:
+		this->RemoveCards(state, move.sourcePile, move.cardCount, cardArray);
+		this->AddCards(state, move.targetPile, move.cardCount, cardArray);
+		break;
+	case Move::Type::DEAL_CARDS:
+		for (int i = 0; i < int(move.cardCount); i++)
+		{
+			Card card = this->stockArray[--state.stockCount];
+			card.SetOrientation(Card::Orientation::FACE_UP);
+			this->AddCards(state, i, 1, &card);
+		}
+		break;
+	case Move::Type::REMOVE_CARDS:
+		this->RemoveCards(state, move.sourcePile, move.cardCount, cardArray);
+		state.removedCount++;
+		break;
+	}
+
+	if ((move.flags & Move::Flags::FLIPPED_CARD) != 0)
+		state.cardArray[this->PileStart(state, move.sourcePile + 1) - 1].SetOrientation(Card::Orientation::FACE_UP);
+}
+
+void SpiderSolver::RemoveRuns(State& state, std::vector<Move>& moveArray) const
+{
+	// This is what the game does on its own every tick.
+	for (int i = 0; i < NUM_TABLEAU_PILES; i++)
+	{
+		while (int(state.pileLength[i]) >= int(Card::NUM_VALUES) && this->TopCard(state, i).GetValue() == Card::Value::ACE)
+		{
+			int j = 1;
+			while (j < int(Card::NUM_VALUES) && this->CardsLink(this->TopCard(state, i, j), this->TopCard(state, i, j - 1)))
+				j++;
+
+			if (j < int(Card::NUM_VALUES))
+				break;
+
+			uint8_t flags = Move::Flags::AUTOMATIC;
+			if (int(state.pileLength[i]) > int(Card::NUM_VALUES) && this->TopCard(state, i, Card::NUM_VALUES).GetOrientation() == Card::Orientation::FACE_DOWN)
+				flags |= Move::Flags::FLIPPED_CARD;
+
+			Move move(Move::Type::REMOVE_CARDS, i, i, int(Card::NUM_VALUES), flags);
+			this->ApplyMove(state, move);
+			moveArray.push_back(move);
+		}
+	}
+}
+
+void SpiderSolver::GenerateActions(const State& state, std::vector<Action>& actionArray) const
+{
+	int firstAction = int(actionArray.size());
+
+	int firstEmptyPile = -1;
+	for (int i = NUM_TABLEAU_PILES - 1; i >= 0; i--)
+		if (state.pileLength[i] == 0)
+			firstEmptyPile = i;
+
+	for (int i = 0; i < NUM_TABLEAU_PILES; i++)
+	{
+		int length = int(state.pileLength[i]);
+		int runLength = this->RunLength(state, i);
+
+		for (int cardCount = 1; cardCount <= runLength; cardCount++)
+		{
+			Card card = this->TopCard(state, i, cardCount - 1);
+
+			// Rate how well the cards sit where they are: 2 on the next card up of the
+			// same suit, 1 on the next card up of another suit, and 0 otherwise.
+			int oldFit = 0;
+			uint8_t flags = 0;
+			if (cardCount < length)
+			{
+				Card lowerCard = this->TopCard(state, i, cardCount);
+				if (lowerCard.GetOrientation() == Card::Orientation::FACE_DOWN)
+					flags |= Move::Flags::FLIPPED_CARD;
+				else if (int(lowerCard.GetValue()) - 1 == int(card.GetValue()))
+					oldFit = this->CardsLink(lowerCard, card) ? 2 : 1;
+			}
+
+			int priority = 0;
+			if (flags != 0)
+				priority += 15;
+			if (cardCount == length)
+				priority += 12;
+
+			for (int j = 0; j < NUM_TABLEAU_PILES; j++)
+			{
+				if (j == i)
+					continue;
+
+				if (state.pileLength[j] > 0)
+				{
+					Card targetCard = this->TopCard(state, j);
+					if (int(targetCard.GetValue()) - 1 != int(card.GetValue()))
+						continue;
+
+					// Moving cards to where they fit no better than they do now gets nowhere.
+					int newFit = this->CardsLink(targetCard, card) ? 2 : 1;
+					if (oldFit > 0 && newFit <= oldFit)
+						continue;
+
+					actionArray.push_back(Action{ Move(Move::Type::MOVE_CARDS, i, j, cardCount, flags), priority + newFit * 10 });
+				}
+				else if (j == firstEmptyPile && cardCount < length && oldFit < 2)
+				{
+					actionArray.push_back(Action{ Move(Move::Type::MOVE_CARDS, i, j, cardCount, flags), (flags != 0) ? 8 : 1 });
+				}
+			}
+		}
+	}
+
+	// The stock is the last resort.
+	if (firstEmptyPile < 0 && state.stockCount > 0)
+	{
+		int cardCount = (state.stockCount < NUM_TABLEAU_PILES) ? int(state.stockCount) : NUM_TABLEAU_PILES;
+		actionArray.push_back(Action{ Move(Move::Type::DEAL_CARDS, 0, 0, cardCount), 0 });
+	}
+
+	std::stable_sort(actionArray.begin() + firstAction, actionArray.end(), [](const Action& actionA, const Action& actionB) {
+		return actionA.priority > actionB.priority;
+	});
+}
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "SolitaireGames/SpiderSolitaireGame.h"
+#include <unordered_map>
+
+// This is an iteratively deepened depth-first search for a way to win a game of
+// Spider at the game's difficulty level, seeing all of the cards.  The piles are
+// packed one after the other into a single array of card bytes, which is what
+// positions are hashed on to find the ones already searched.  Building on cards
+// of the same suit, uncovering cards and emptying piles are tried first.
+class SpiderSolver
+{
+public:
+	SpiderSolver();
+	virtual ~SpiderSolver();
+
+	enum Result
+	{
+		SOLVED,
+		UNSOLVABLE,
+		GAVE_UP
+	};
+
+	// When solved, the given moves can be passed in order to the game's ApplyMove() to win it.
+	Result Solve(const SpiderSolitaireGame* game, std::vector<SolitaireGame::Move>& solution);
+
+	void SetNodeLimit(int nodeLimit);
+	int GetNodeCount() const;
+
+private:
+	typedef SolitaireGame::Card Card;
+	typedef SolitaireGame::Move Move;
+
+	enum
+	{
+		NUM_TABLEAU_PILES = SpiderSolitaireGame::NUM_TABLEAU_PILES,
+		NUM_CARDS = 2 * int(Card::NUM_SUITS) * int(Card::NUM_VALUES),
+		NUM_RUNS = NUM_CARDS / int(Card::NUM_VALUES),
+		INITIAL_DEPTH_LIMIT = 128,
+		MAX_DEPTH_LIMIT = 4096
+	};
+
+	struct State
+	{
+		Card cardArray[NUM_CARDS];
+		uint8_t pileLength[NUM_TABLEAU_PILES];
+		uint8_t stockCount;
+		uint8_t removedCount;
+	};
+
+	struct Action
+	{
+		Move move;
+		int priority;
+	};
+
+	enum SearchResult
+	{
+		FOUND,
+		NOT_FOUND,
+		CUT_OFF,
+		OUT_OF_NODES
+	};
+
+	bool LoadState(const SpiderSolitaireGame* game, State& state);
+	uint64_t CalcHash(const State& state) const;
+	int PileStart(const State& state, int pile) const;
+	Card TopCard(const State& state, int pile, int depth = 0) const;
+	bool CardsLink(Card lowerCard, Card upperCard) const;
+	int RunLength(const State& state, int pile) const;
+	void RemoveCards(State& state, int pile, int cardCount, Card* cardArray) const;
+	void AddCards(State& state, int pile, int cardCount, const Card* cardArray) const;
+	void ApplyMove(State& state, const Move& move) const;
+	void RemoveRuns(State& state, std::vector<Move>& moveArray) const;
+	void GenerateActions(const State& state, std::vector<Action>& actionArray) const;
+	SearchResult Search(const State& rootState, int depthLimit);
+
+	SpiderSolitaireGame::DifficultyLevel difficultyLevel;
+	std::vector<Card> stockArray;
+	std::unordered_map<uint64_t, int> visitedMap;
+	std::vector<Move> pathArray;
+	int nodeLimit;
+	int nodeCount;
+};
\ No newline at end of file
@@ -0,0 +1,120 @@
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <assert.h>
+
+SpatialGrid::SpatialGrid()
+{
+	this->cellWidth = 1.0;
+	this->cellHeight = 1.0;
+	this->columnCount = 0;
+	this->rowCount = 0;
+}
+
+/*virtual*/ SpatialGrid::~SpatialGrid()
+{
+}
+
+void SpatialGrid::Reset(const Box& extents, double cellWidth, double cellHeight, int ownerCount)
+{
+	assert(cellWidth > 0.0 && cellHeight > 0.0);
+
+	this->extents = extents;
+	this->cellWidth = cellWidth;
+	this->cellHeight = cellHeight;
+	this->columnCount = std::max(1, int(::ceil(extents.GetWidth() / cellWidth)));
+	this->rowCount = std::max(1, int(::ceil(extents.GetHeight() / cellHeight)));
+
+	// Keep the cells' memory around from one game to the next.
+	this->cellArray.resize(this->columnCount * this->rowCount);
+	for (Cell& cell : this->cellArray)
+	{
+		cell.entryArray.clear();
+		cell.boxArray.Clear();
+	}
+
+	// An owner with nothing in the grid has a span that covers no cells.
+	this->ownerSpanArray.assign(ownerCount, CellSpan{ 0, -1, 0, -1 });
+}
+
+void SpatialGrid::RemoveOwner(int owner)
+{
+	CellSpan& span = this->ownerSpanArray[owner];
+
+	for (int row = span.minRow; row <= span.maxRow; row++)
+	{
+		for (int column = span.minColumn; column <= span.maxColumn; column++)
+		{
+			Cell& cell = this->cellArray[row * this->columnCount + column];
+			for (int i = int(cell.entryArray.size()) - 1; i >= 0; i--)
+			{
+				if (cell.entryArray[i].owner == owner)
+				{
+					cell.entryArray.erase(cell.entryArray.begin() + i);
+					cell.boxArray.RemoveAt(i);
+				}
+			}
+		}
+	}
+
+	span = CellSpan{ 0, -1, 0, -1 };
+}
+
+void SpatialGrid::Insert(int owner, int item, const Box& box)
+{
+	assert(0 <= owner && owner < int(this->ownerSpanArray.size()));
+
+	int minColumn = this->ColumnAt(box.min.x);
+	int maxColumn = this->ColumnAt(box.max.x);
+	int minRow = this->RowAt(box.min.y);
+	int maxRow = this->RowAt(box.max.y);
+
+	for (int row = minRow; row <= maxRow; row++)
+	{
+		for (int column = minColumn; column <= maxColumn; column++)
+		{
+			Cell& cell = this->cellArray[row * this->columnCount + column];
+			cell.entryArray.push_back(Entry{ uint16_t(owner), uint16_t(item) });
+			cell.boxArray.Add(box);
+		}
+	}
+
+	// Remember every cell the owner is in so that it can be taken out again without searching the whole grid.
+	CellSpan& span = this->ownerSpanArray[owner];
+	if (span.minColumn > span.maxColumn)
+		span = CellSpan{ minColumn, maxColumn, minRow, maxRow };
+	else
+	{
+		span.minColumn = std::min(span.minColumn, minColumn);
+		span.maxColumn = std::max(span.maxColumn, maxColumn);
+		span.minRow = std::min(span.minRow, minRow);
+		span.maxRow = std::max(span.maxRow, maxRow);
+	}
+}
+
+void SpatialGrid::FindEntriesAt(const Vector2D& point, std::vector<Entry>& entryArray) const
+{
+	assert(this->cellArray.size() > 0);
+
+	const Cell& cell = this->cellArray[this->RowAt(point.y) * this->columnCount + this->ColumnAt(point.x)];
+
+	Box pointBox;
+	pointBox.min = point;
+	pointBox.max = point;
+
+	this->indexArray.clear();
+	cell.boxArray.FindOverlapping(pointBox, this->indexArray);
+	for (int i : this->indexArray)
+		entryArray.push_back(cell.entryArray[i]);
+}
+
+int SpatialGrid::ColumnAt(double x) const
+{
+	double column = ::floor((x - this->extents.min.x) / this->cellWidth);
+	return int(std::clamp(column, 0.0, double(this->columnCount - 1)));
+}
+
+int SpatialGrid::RowAt(double y) const
+{
+	double row = ::floor((y - this->extents.min.y) / this->cellHeight);
+	return int(std::clamp(row, 0.0, double(this->rowCount - 1)));
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+#include "BoxArray.h"
+
+// This is a uniform grid of cells laid over a box, each cell listing the items whose
+// boxes overlap it, so that finding what's under a point means testing the boxes of
+// just the one cell the point is in, which is done several boxes at a time.  Items are
+// grouped by owner, and everything an owner has in the grid is replaced at once.  The
+// cells along the edges of the grid reach out without limit, so items outside of the
+// box are found all the same.
+class SpatialGrid
+{
+public:
+	SpatialGrid();
+	virtual ~SpatialGrid();
+
+	struct Entry
+	{
+		uint16_t owner;
+		uint16_t item;
+	};
+
+	void Reset(const Box& extents, double cellWidth, double cellHeight, int ownerCount);
+	void RemoveOwner(int owner);
+	void Insert(int owner, int item, const Box& box);
+
+	// This appends every item whose box contains the given point, in no particular order.
+	void FindEntriesAt(const Vector2D& point, std::vector<Entry>& entryArray) const;
+
+private:
+	int ColumnAt(double x) const;
+	int RowAt(double y) const;
+
+	// The boxes run parallel to the entries.
+	struct Cell
+	{
+		std::vector<Entry> entryArray;
+		BoxArray boxArray;
+	};
+
+	struct CellSpan
+	{
+		int minColumn, maxColumn;
+		int minRow, maxRow;
+	};
+
+	Box extents;
+	double cellWidth;
+	double cellHeight;
+	int columnCount;
+	int rowCount;
+	std::vector<Cell> cellArray;
+	std::vector<CellSpan> ownerSpanArray;
+	mutable std::vector<int> indexArray;
+};
\ No newline at end of file
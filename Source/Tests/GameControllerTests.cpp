@@ -0,0 +1,48 @@
+#include "Tests.h"
+#include "GameController.h"
+#include "SolitaireGames/SpiderSolitaireGame.h"
+
+// Cards grabbed before a deal, undo or redo and dropped after it must not end up in the
+// history, or taking every move back leads somewhere other than the deal.
+bool TestGameController()
+{
+	Box cardSize = SolitaireGame::MakeCardSize();
+	auto game = std::make_shared<SpiderSolitaireGame>(SolitaireGame::MakeWorldExtents(), cardSize, SpiderSolitaireGame::DifficultyLevel::LOW);
+	game->NewGame(7);
+	uint64_t dealtHash = game->GetHash();
+
+	GameController gameController;
+	gameController.SetGame(game);
+
+	// Each time, the top card of the first pile is picked up once everything has landed, and dropped back where it was.
+	Vector2D grabPoint;
+	auto grabTopCard = [&]() -> bool {
+		for (int i = 0; i < 120; i++)
+			gameController.Tick(1.0 / 60.0);
+
+		grabPoint = game->GetPile(0)->visualArray.back().position + cardSize.GetCenter();
+		return gameController.OnMouseGrab(grabPoint);
+	};
+
+	TEST_CHECK(grabTopCard());
+	TEST_CHECK(gameController.OnCardsNeeded(1.0));
+	gameController.OnMouseRelease(grabPoint);
+	TEST_CHECK(gameController.GetHistory().GetMoveCount() == 1);
+
+	TEST_CHECK(grabTopCard());
+	TEST_CHECK(gameController.Undo());
+	gameController.OnMouseRelease(grabPoint);
+	TEST_CHECK(game->GetHash() == dealtHash);
+
+	TEST_CHECK(grabTopCard());
+	TEST_CHECK(gameController.Redo());
+	gameController.OnMouseRelease(grabPoint);
+
+	while (gameController.Undo())
+		;
+
+	TEST_CHECK(game->GetHash() == dealtHash);
+	TEST_CHECK(game->GetHash() == game->CalcHash());
+
+	return true;
+}
\ No newline at end of file
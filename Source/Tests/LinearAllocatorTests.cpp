@@ -0,0 +1,41 @@
+#include "Tests.h"
+#include "LinearAllocator.h"
+
+// This checks that the allocator hands out aligned space that never overlaps within a frame,
+// grows past its page on demand, and settles back into a single page big enough for the load.
+bool TestLinearAllocator()
+{
+	LinearAllocator allocator(1024);
+
+	for (int frame = 0; frame < 3; frame++)
+	{
+		// Only the frame after the one that spilled over should replace its pages.
+		bool pagesReplaced = allocator.Reset();
+		TEST_CHECK(pagesReplaced == (frame == 1));
+		TEST_CHECK(allocator.GetUsedSize() == 0);
+
+		// This is a little over 4K, so the first frame must spill over onto more pages.
+		uint64_t endArray[8] = {};
+		for (int i = 0; i < 33; i++)
+		{
+			uint64_t size = (i % 3 == 0) ? 256 : 40;
+			uint64_t alignment = (i % 3 == 0) ? 256 : 16;
+			LinearAllocator::Allocation allocation = allocator.Allocate(size, alignment);
+			TEST_CHECK(allocation.page >= 0 && allocation.page < allocator.GetPageCount() && allocation.page < 8);
+			TEST_CHECK(allocation.offset % alignment == 0);
+			TEST_CHECK(allocation.offset >= endArray[allocation.page]);
+			TEST_CHECK(allocation.offset + size <= allocator.GetPageSize(allocation.page));
+
+			endArray[allocation.page] = allocation.offset + size;
+		}
+
+		TEST_CHECK((frame == 0) == (allocator.GetPageCount() > 1));
+	}
+
+	// Anything bigger than a whole page still gets a page of its own.
+	LinearAllocator::Allocation allocation = allocator.Allocate(1 << 20, 256);
+	TEST_CHECK(allocation.offset == 0);
+	TEST_CHECK(allocator.GetPageSize(allocation.page) >= (1 << 20));
+
+	return true;
+}
\ No newline at end of file
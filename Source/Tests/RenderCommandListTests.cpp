@@ -0,0 +1,73 @@
+#include "Tests.h"
+#include "RenderCommandList.h"
+#include "SolitaireGames/KlondikeSolitaireGame.h"
+#include "SolitaireGames/FreeCellSolitaireGame.h"
+#include "SolitaireGames/SpiderSolitaireGame.h"
+
+// This checks that a frame is batched into a single draw of every card, in order.
+static bool CheckCardBatch(const RenderCommandList& renderCommandList, const std::vector<SolitaireGame::RenderItem>& renderList, const Box& cardSize)
+{
+	const std::vector<RenderCommandList::Command>& commandArray = renderCommandList.GetCommandArray();
+	TEST_CHECK(commandArray.size() == 1);
+	TEST_CHECK(commandArray[0].type == RenderCommandList::Command::Type::DRAW_INSTANCED);
+	TEST_CHECK(commandArray[0].vertexCount == CARD_VERTEX_COUNT);
+	TEST_CHECK(commandArray[0].firstInstance == 0);
+	TEST_CHECK(commandArray[0].instanceCount == renderList.size());
+
+	const std::vector<RenderCommandList::CardInstance>& instanceArray = renderCommandList.GetInstanceArray();
+	TEST_CHECK(instanceArray.size() == renderList.size());
+
+	for (int i = 0; i < int(renderList.size()); i++)
+	{
+		const RenderCommandList::CardInstance& instance = instanceArray[i];
+		TEST_CHECK(instance.textureIndex == uint32_t(renderList[i].card.GetTextureIndex()));
+		TEST_CHECK(instance.position[0] == renderList[i].position.x && instance.position[1] == renderList[i].position.y);
+		TEST_CHECK(instance.size[0] == float(cardSize.GetWidth()) && instance.size[1] == float(cardSize.GetHeight()));
+	}
+
+	return true;
+}
+
+static bool CheckGameBatch(SolitaireGame& game)
+{
+	game.NewGame(20240101);
+
+	std::vector<SolitaireGame::RenderItem> renderList;
+	game.GenerateRenderList(renderList);
+	TEST_CHECK(renderList.size() > 0);
+
+	// Every frame starts afresh, however many came before it.
+	Box cardSize = SolitaireGame::MakeCardSize();
+	RenderCommandList renderCommandList;
+	for (int frame = 0; frame < 2; frame++)
+	{
+		renderCommandList.Reset();
+		renderCommandList.RecordCards(renderList, cardSize);
+		TEST_CHECK(CheckCardBatch(renderCommandList, renderList, cardSize));
+	}
+
+	return true;
+}
+
+bool TestRenderCommandList()
+{
+	Box worldExtents = SolitaireGame::MakeWorldExtents();
+	Box cardSize = SolitaireGame::MakeCardSize();
+
+	KlondikeSolitaireGame klondikeGame(worldExtents, cardSize);
+	TEST_CHECK(CheckGameBatch(klondikeGame));
+
+	FreeCellSolitaireGame freeCellGame(worldExtents, cardSize);
+	TEST_CHECK(CheckGameBatch(freeCellGame));
+
+	SpiderSolitaireGame spiderGame(worldExtents, cardSize, SpiderSolitaireGame::DifficultyLevel::LOW);
+	TEST_CHECK(CheckGameBatch(spiderGame));
+
+	// Nothing to draw records no draw at all.
+	RenderCommandList renderCommandList;
+	renderCommandList.RecordCards(std::vector<SolitaireGame::RenderItem>(), cardSize);
+	TEST_CHECK(renderCommandList.GetCommandArray().size() == 0);
+	TEST_CHECK(renderCommandList.GetInstanceArray().size() == 0);
+
+	return true;
+}
\ No newline at end of file
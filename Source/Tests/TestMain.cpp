@@ -0,0 +1,55 @@
+#include "Tests.h"
+#include <cstring>
+
+// Usage: solitaire-tests [<test name>...]
+// With no names, every test is run.
+
+struct Test
+{
+	const char* name;
+	bool (*function)();
+};
+
+static const Test testArray[] =
+{
+	{ "RenderCommandList", TestRenderCommandList },
+	{ "LinearAllocator", TestLinearAllocator },
+	{ "GameController", TestGameController },
+};
+
+static bool RunTest(const Test& test)
+{
+	bool passed = test.function();
+	printf("%-24s %s\n", test.name, passed ? "passed" : "FAILED");
+	return passed;
+}
+
+int main(int argc, char** argv)
+{
+	int failedCount = 0;
+
+	if (argc == 1)
+	{
+		for (const Test& test : testArray)
+			if (!RunTest(test))
+				failedCount++;
+	}
+
+	for (int i = 1; i < argc; i++)
+	{
+		const Test* foundTest = nullptr;
+		for (const Test& test : testArray)
+			if (::strcmp(test.name, argv[i]) == 0)
+				foundTest = &test;
+
+		if (!foundTest)
+		{
+			fprintf(stderr, "There's no test named \"%s\".\n", argv[i]);
+			failedCount++;
+		}
+		else if (!RunTest(*foundTest))
+			failedCount++;
+	}
+
+	return (failedCount == 0) ? 0 : 1;
+}
\ No newline at end of file
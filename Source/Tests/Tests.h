@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdio>
+
+// A failed check names itself and fails the test it's in.
+#define TEST_CHECK(condition) \
+	do \
+	{ \
+		if (!(condition)) \
+		{ \
+			fprintf(stderr, "%s(%d): check failed: %s\n", __FILE__, __LINE__, #condition); \
+			return false; \
+		} \
+	} while (false)
+
+// Each of these returns true if everything it checks holds.
+bool TestRenderCommandList();
+bool TestLinearAllocator();
+bool TestGameController();
\ No newline at end of file
@@ -0,0 +1,382 @@
+#include "TextureArray.h"
+#include <fstream>
+#include <filesystem>
+#include <string.h>
+#include <utility>
+
+// These are the parts of the DDS format that uncompressed 32-bit textures use.
+enum : uint32_t
+{
+	DDS_MAGIC = 0x20534444,				// "DDS "
+	DDS_HEADER_SIZE = 124,
+	DDS_PIXEL_FORMAT_SIZE = 32,
+	DDS_DX10_FOURCC = 0x30315844,		// "DX10"
+	DDSD_CAPS = 0x1,
+	DDSD_HEIGHT = 0x2,
+	DDSD_WIDTH = 0x4,
+	DDSD_PITCH = 0x8,
+	DDSD_PIXELFORMAT = 0x1000,
+	DDSD_MIPMAPCOUNT = 0x20000,
+	DDPF_FOURCC = 0x4,
+	DDPF_RGB = 0x40,
+	DDSCAPS_COMPLEX = 0x8,
+	DDSCAPS_TEXTURE = 0x1000,
+	DDSCAPS_MIPMAP = 0x400000,
+	DXGI_FORMAT_R8G8B8A8_UNORM_VALUE = 28,
+	D3D10_RESOURCE_DIMENSION_TEXTURE2D_VALUE = 3
+};
+
+// These are byte offsets from the start of a DDS file.
+enum : size_t
+{
+	HEADER_FLAGS_OFFSET = 8,
+	HEADER_HEIGHT_OFFSET = 12,
+	HEADER_WIDTH_OFFSET = 16,
+	HEADER_PITCH_OFFSET = 20,
+	HEADER_MIP_COUNT_OFFSET = 28,
+	PIXEL_FORMAT_OFFSET = 76,
+	PIXEL_FORMAT_FLAGS_OFFSET = 80,
+	PIXEL_FORMAT_FOURCC_OFFSET = 84,
+	PIXEL_FORMAT_BIT_COUNT_OFFSET = 88,
+	PIXEL_FORMAT_RED_MASK_OFFSET = 92,
+	PIXEL_FORMAT_GREEN_MASK_OFFSET = 96,
+	PIXEL_FORMAT_BLUE_MASK_OFFSET = 100,
+	PIXEL_FORMAT_ALPHA_MASK_OFFSET = 104,
+	HEADER_CAPS_OFFSET = 108,
+	HEADER_CAPS2_OFFSET = 112,
+	DX10_HEADER_OFFSET = 128,
+	DX10_FORMAT_OFFSET = 128,
+	DX10_DIMENSION_OFFSET = 132,
+	DX10_ARRAY_SIZE_OFFSET = 140,
+	DX10_HEADER_END = 148
+};
+
+static uint32_t ReadUInt32(const std::vector<uint8_t>& byteArray, size_t offset)
+{
+	const uint8_t* data = &byteArray[offset];
+	return uint32_t(data[0]) | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+}
+
+static void WriteUInt32(std::vector<uint8_t>& byteArray, size_t offset, uint32_t value)
+{
+	uint8_t* data = &byteArray[offset];
+	data[0] = uint8_t(value);
+	data[1] = uint8_t(value >> 8);
+	data[2] = uint8_t(value >> 16);
+	data[3] = uint8_t(value >> 24);
+}
+
+static void AppendUInt32(std::vector<uint8_t>& byteArray, uint32_t value)
+{
+	byteArray.resize(byteArray.size() + 4);
+	WriteUInt32(byteArray, byteArray.size() - 4, value);
+}
+
+TextureArray::TextureArray()
+{
+	this->width = 0;
+	this->height = 0;
+	this->mipCount = 0;
+}
+
+/*virtual*/ TextureArray::~TextureArray()
+{
+}
+
+void TextureArray::Clear()
+{
+	this->nameArray.clear();
+	this->pixelArray.clear();
+	this->width = 0;
+	this->height = 0;
+	this->mipCount = 0;
+}
+
+bool TextureArray::AddSliceFromFile(const std::string& filePath, const std::string& name)
+{
+	std::vector<uint8_t> byteArray;
+	FileHeader header;
+	if (!ReadFile(filePath, byteArray) || !ReadFileHeader(byteArray, header) || header.arraySize != 1)
+		return false;
+
+	if (this->nameArray.size() == 0)
+	{
+		this->width = header.width;
+		this->height = header.height;
+		this->mipCount = header.mipCount;
+	}
+	else if (header.width != this->width || header.height != this->height || header.mipCount != this->mipCount)
+		return false;
+
+	size_t sliceSize = CalcSliceSize(this->width, this->height, this->mipCount);
+	if (byteArray.size() < header.pixelOffset + sliceSize)
+		return false;
+
+	size_t sliceOffset = this->pixelArray.size();
+	this->pixelArray.insert(this->pixelArray.end(), byteArray.begin() + header.pixelOffset, byteArray.begin() + header.pixelOffset + sliceSize);
+
+	if (header.swapRedAndBlue)
+		for (size_t i = sliceOffset; i < this->pixelArray.size(); i += 4)
+			std::swap(this->pixelArray[i], this->pixelArray[i + 2]);
+
+	this->nameArray.push_back(name);
+	return true;
+}
+
+bool TextureArray::AddSlicesFromFolder(const std::string& folderPath, const std::vector<std::string>& nameArray, std::string& failedFilePath)
+{
+	for (const std::string& name : nameArray)
+	{
+		std::filesystem::path filePath = std::filesystem::path(folderPath) / (name + ".dds");
+		if (!this->AddSliceFromFile(filePath.string(), name))
+		{
+			failedFilePath = filePath.string();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool TextureArray::LoadFile(const std::string& filePath)
+{
+	this->Clear();
+
+	std::vector<uint8_t> byteArray;
+	FileHeader header;
+	if (!ReadFile(filePath, byteArray) || !ReadFileHeader(byteArray, header))
+		return false;
+
+	size_t sliceSize = CalcSliceSize(header.width, header.height, header.mipCount);
+	size_t namesOffset = header.pixelOffset + sliceSize * header.arraySize;
+	if (byteArray.size() < namesOffset + TEXTURE_ARRAY_NAMES_MAGIC_SIZE + 4)
+		return false;
+
+	// Without its names, there's no telling which slice is which.
+	if (::memcmp(&byteArray[namesOffset], TEXTURE_ARRAY_NAMES_MAGIC, TEXTURE_ARRAY_NAMES_MAGIC_SIZE) != 0)
+		return false;
+
+	size_t offset = namesOffset + TEXTURE_ARRAY_NAMES_MAGIC_SIZE;
+	if (ReadUInt32(byteArray, offset) != header.arraySize)
+		return false;
+	offset += 4;
+
+	for (uint32_t i = 0; i < header.arraySize; i++)
+	{
+		if (byteArray.size() < offset + 4)
+			return false;
+		uint32_t nameLength = ReadUInt32(byteArray, offset);
+		offset += 4;
+		if (byteArray.size() < offset + nameLength)
+			return false;
+		this->nameArray.push_back(std::string((const char*)&byteArray[offset], nameLength));
+		offset += nameLength;
+	}
+
+	this->width = header.width;
+	this->height = header.height;
+	this->mipCount = header.mipCount;
+	this->pixelArray.assign(byteArray.begin() + header.pixelOffset, byteArray.begin() + namesOffset);
+
+	if (header.swapRedAndBlue)
+		for (size_t i = 0; i < this->pixelArray.size(); i += 4)
+			std::swap(this->pixelArray[i], this->pixelArray[i + 2]);
+
+	return true;
+}
+
+bool TextureArray::SaveFile(const std::string& filePath) const
+{
+	if (this->nameArray.size() == 0)
+		return false;
+
+	std::vector<uint8_t> byteArray(DX10_HEADER_END, 0);
+
+	uint32_t flags = DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PITCH | DDSD_PIXELFORMAT | DDSD_MIPMAPCOUNT;
+	uint32_t caps = DDSCAPS_TEXTURE | ((this->mipCount > 1) ? (DDSCAPS_COMPLEX | DDSCAPS_MIPMAP) : 0);
+
+	WriteUInt32(byteArray, 0, DDS_MAGIC);
+	WriteUInt32(byteArray, 4, DDS_HEADER_SIZE);
+	WriteUInt32(byteArray, HEADER_FLAGS_OFFSET, flags);
+	WriteUInt32(byteArray, HEADER_HEIGHT_OFFSET, this->height);
+	WriteUInt32(byteArray, HEADER_WIDTH_OFFSET, this->width);
+	WriteUInt32(byteArray, HEADER_PITCH_OFFSET, this->width * 4);
+	WriteUInt32(byteArray, HEADER_MIP_COUNT_OFFSET, this->mipCount);
+	WriteUInt32(byteArray, PIXEL_FORMAT_OFFSET, DDS_PIXEL_FORMAT_SIZE);
+	WriteUInt32(byteArray, PIXEL_FORMAT_FLAGS_OFFSET, DDPF_FOURCC);
+	WriteUInt32(byteArray, PIXEL_FORMAT_FOURCC_OFFSET, DDS_DX10_FOURCC);
+	WriteUInt32(byteArray, HEADER_CAPS_OFFSET, caps);
+	WriteUInt32(byteArray, DX10_FORMAT_OFFSET, DXGI_FORMAT_R8G8B8A8_UNORM_VALUE);
+	WriteUInt32(byteArray, DX10_DIMENSION_OFFSET, D3D10_RESOURCE_DIMENSION_TEXTURE2D_VALUE);
+	WriteUInt32(byteArray, DX10_ARRAY_SIZE_OFFSET, uint32_t(this->nameArray.size()));
+
+	byteArray.insert(byteArray.end(), this->pixelArray.begin(), this->pixelArray.end());
+
+	byteArray.insert(byteArray.end(), TEXTURE_ARRAY_NAMES_MAGIC, TEXTURE_ARRAY_NAMES_MAGIC + TEXTURE_ARRAY_NAMES_MAGIC_SIZE);
+	AppendUInt32(byteArray, uint32_t(this->nameArray.size()));
+	for (const std::string& name : this->nameArray)
+	{
+		AppendUInt32(byteArray, uint32_t(name.length()));
+		byteArray.insert(byteArray.end(), name.begin(), name.end());
+	}
+
+	std::ofstream fileStream(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!fileStream.is_open())
+		return false;
+
+	fileStream.write((const char*)byteArray.data(), byteArray.size());
+	return fileStream.good();
+}
+
+int TextureArray::FindSlice(const std::string& name) const
+{
+	for (int i = 0; i < int(this->nameArray.size()); i++)
+		if (this->nameArray[i] == name)
+			return i;
+
+	return -1;
+}
+
+const std::string& TextureArray::GetSliceName(int slice) const
+{
+	return this->nameArray[slice];
+}
+
+int TextureArray::GetSliceCount() const
+{
+	return int(this->nameArray.size());
+}
+
+uint32_t TextureArray::GetWidth() const
+{
+	return this->width;
+}
+
+uint32_t TextureArray::GetHeight() const
+{
+	return this->height;
+}
+
+uint32_t TextureArray::GetMipCount() const
+{
+	return this->mipCount;
+}
+
+uint32_t TextureArray::GetMipWidth(uint32_t mip) const
+{
+	uint32_t mipWidth = this->width >> mip;
+	return (mipWidth > 0) ? mipWidth : 1;
+}
+
+uint32_t TextureArray::GetMipHeight(uint32_t mip) const
+{
+	uint32_t mipHeight = this->height >> mip;
+	return (mipHeight > 0) ? mipHeight : 1;
+}
+
+const uint8_t* TextureArray::GetPixels(int slice, uint32_t mip) const
+{
+	// Each slice holds all of its mips, largest first, before the next slice begins.
+	size_t offset = CalcSliceSize(this->width, this->height, this->mipCount) * size_t(slice);
+	for (uint32_t i = 0; i < mip; i++)
+		offset += size_t(this->GetMipWidth(i)) * this->GetMipHeight(i) * 4;
+
+	return &this->pixelArray[offset];
+}
+
+bool TextureArray::operator==(const TextureArray& textureArray) const
+{
+	return this->width == textureArray.width &&
+		this->height == textureArray.height &&
+		this->mipCount == textureArray.mipCount &&
+		this->nameArray == textureArray.nameArray &&
+		this->pixelArray == textureArray.pixelArray;
+}
+
+/*static*/ bool TextureArray::ReadFile(const std::string& filePath, std::vector<uint8_t>& byteArray)
+{
+	byteArray.clear();
+
+	std::ifstream fileStream(filePath, std::ios::in | std::ios::binary | std::ios::ate);
+	if (!fileStream.is_open())
+		return false;
+
+	std::streamoff fileSize = fileStream.tellg();
+	if (fileSize < 0)
+		return false;
+
+	byteArray.resize(size_t(fileSize));
+	fileStream.seekg(0);
+	fileStream.read((char*)byteArray.data(), fileSize);
+	return fileStream.good();
+}
+
+/*static*/ bool TextureArray::ReadFileHeader(const std::vector<uint8_t>& byteArray, FileHeader& header)
+{
+	if (byteArray.size() < DX10_HEADER_OFFSET || ReadUInt32(byteArray, 0) != DDS_MAGIC || ReadUInt32(byteArray, 4) != DDS_HEADER_SIZE)
+		return false;
+
+	// Cube maps and volume textures are of no use here.
+	if (ReadUInt32(byteArray, HEADER_CAPS2_OFFSET) != 0)
+		return false;
+
+	header.width = ReadUInt32(byteArray, HEADER_WIDTH_OFFSET);
+	header.height = ReadUInt32(byteArray, HEADER_HEIGHT_OFFSET);
+	header.mipCount = (ReadUInt32(byteArray, HEADER_FLAGS_OFFSET) & DDSD_MIPMAPCOUNT) ? ReadUInt32(byteArray, HEADER_MIP_COUNT_OFFSET) : 1;
+	if (header.mipCount == 0)
+		header.mipCount = 1;
+	if (header.width == 0 || header.height == 0 || header.width > TEXTURE_ARRAY_MAX_SIZE || header.height > TEXTURE_ARRAY_MAX_SIZE || header.mipCount > 32)
+		return false;
+
+	uint32_t pixelFormatFlags = ReadUInt32(byteArray, PIXEL_FORMAT_FLAGS_OFFSET);
+	if ((pixelFormatFlags & DDPF_FOURCC) != 0)
+	{
+		if (ReadUInt32(byteArray, PIXEL_FORMAT_FOURCC_OFFSET) != DDS_DX10_FOURCC || byteArray.size() < DX10_HEADER_END)
+			return false;
+		if (ReadUInt32(byteArray, DX10_FORMAT_OFFSET) != DXGI_FORMAT_R8G8B8A8_UNORM_VALUE)
+			return false;
+		if (ReadUInt32(byteArray, DX10_DIMENSION_OFFSET) != D3D10_RESOURCE_DIMENSION_TEXTURE2D_VALUE)
+			return false;
+
+		header.arraySize = ReadUInt32(byteArray, DX10_ARRAY_SIZE_OFFSET);
+		header.pixelOffset = DX10_HEADER_END;
+		header.swapRedAndBlue = false;
+	}
+	else
+	{
+		if ((pixelFormatFlags & DDPF_RGB) == 0 || ReadUInt32(byteArray, PIXEL_FORMAT_BIT_COUNT_OFFSET) != 32)
+			return false;
+
+		uint32_t redMask = ReadUInt32(byteArray, PIXEL_FORMAT_RED_MASK_OFFSET);
+		uint32_t greenMask = ReadUInt32(byteArray, PIXEL_FORMAT_GREEN_MASK_OFFSET);
+		uint32_t blueMask = ReadUInt32(byteArray, PIXEL_FORMAT_BLUE_MASK_OFFSET);
+		if (greenMask != 0x0000FF00)
+			return false;
+
+		// Both RGBA and BGRA byte orders are common, and the latter is swapped around as it's read.
+		if (redMask == 0x000000FF && blueMask == 0x00FF0000)
+			header.swapRedAndBlue = false;
+		else if (redMask == 0x00FF0000 && blueMask == 0x000000FF)
+			header.swapRedAndBlue = true;
+		else
+			return false;
+
+		header.arraySize = 1;
+		header.pixelOffset = DX10_HEADER_OFFSET;
+	}
+
+	return header.arraySize > 0;
+}
+
+/*static*/ size_t TextureArray::CalcSliceSize(uint32_t width, uint32_t height, uint32_t mipCount)
+{
+	size_t sliceSize = 0;
+	for (uint32_t i = 0; i < mipCount; i++)
+	{
+		size_t mipWidth = (width >> i) > 0 ? (width >> i) : 1;
+		size_t mipHeight = (height >> i) > 0 ? (height >> i) : 1;
+		sliceSize += mipWidth * mipHeight * 4;
+	}
+
+	return sliceSize;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <stdint.h>
+
+#define TEXTURE_ARRAY_NAMES_MAGIC		"SNAM"
+#define TEXTURE_ARRAY_NAMES_MAGIC_SIZE	4
+
+// This is as wide or tall as Direct3D 12 lets a texture be.
+#define TEXTURE_ARRAY_MAX_SIZE			16384
+
+// This packs textures of the same size into the slices of a single texture array, so that
+// the renderer can bind every card texture at once and pick one out by its slice number.
+// Slices are read from DDS files holding one uncompressed 32-bit texture each, which is how
+// the card art is kept, and the array is written out as a single DDS file with a DX10 header,
+// the pixels always in RGBA order.  The slice names are appended after the pixel data, where
+// other DDS readers don't look, so that a packed file can be loaded back with its names.
+class TextureArray
+{
+public:
+	TextureArray();
+	virtual ~TextureArray();
+
+	void Clear();
+
+	// The first slice added sets the size and mip count, and every slice after it must match.
+	bool AddSliceFromFile(const std::string& filePath, const std::string& name);
+
+	// This adds the DDS file in the folder of each given name, without its extension, in the given order.
+	// If one can't be added, its path is given back and nothing after it is added.
+	bool AddSlicesFromFolder(const std::string& folderPath, const std::vector<std::string>& nameArray, std::string& failedFilePath);
+
+	bool LoadFile(const std::string& filePath);
+	bool SaveFile(const std::string& filePath) const;
+
+	// This is -1 if no slice has the given name.
+	int FindSlice(const std::string& name) const;
+	const std::string& GetSliceName(int slice) const;
+	int GetSliceCount() const;
+
+	uint32_t GetWidth() const;
+	uint32_t GetHeight() const;
+	uint32_t GetMipCount() const;
+	uint32_t GetMipWidth(uint32_t mip) const;
+	uint32_t GetMipHeight(uint32_t mip) const;
+
+	// The rows of pixels are packed tightly, four bytes to a pixel.
+	const uint8_t* GetPixels(int slice, uint32_t mip) const;
+
+	bool operator==(const TextureArray& textureArray) const;
+
+private:
+	struct FileHeader
+	{
+		uint32_t width;
+		uint32_t height;
+		uint32_t mipCount;
+		uint32_t arraySize;
+		size_t pixelOffset;
+		bool swapRedAndBlue;
+	};
+
+	static bool ReadFile(const std::string& filePath, std::vector<uint8_t>& byteArray);
+	static bool ReadFileHeader(const std::vector<uint8_t>& byteArray, FileHeader& header);
+	static size_t CalcSliceSize(uint32_t width, uint32_t height, uint32_t mipCount);
+
+	std::vector<std::string> nameArray;
+	std::vector<uint8_t> pixelArray;
+	uint32_t width;
+	uint32_t height;
+	uint32_t mipCount;
+};
\ No newline at end of file
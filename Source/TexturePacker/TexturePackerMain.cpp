@@ -0,0 +1,43 @@
+#include "TextureArray.h"
+#include "SolitaireGame.h"
+#include <cstdio>
+
+// Usage: solitaire-pack-textures <texture folder> <output file>
+int main(int argc, char** argv)
+{
+	if (argc != 3)
+	{
+		fprintf(stderr, "Usage: %s <texture folder> <output file>\n", argv[0]);
+		return 1;
+	}
+
+	// The slices go in the order the cards number their textures, so that a card's texture index is its slice.
+	std::vector<std::string> renderKeyArray;
+	SolitaireGame::Card::GetAllRenderKeys(renderKeyArray);
+
+	TextureArray textureArray;
+	std::string failedFilePath;
+	if (!textureArray.AddSlicesFromFolder(argv[1], renderKeyArray, failedFilePath))
+	{
+		fprintf(stderr, "Failed to add \"%s\".  Every texture must be an uncompressed 32-bit DDS file of the same size.\n", failedFilePath.c_str());
+		return 1;
+	}
+
+	if (!textureArray.SaveFile(argv[2]))
+	{
+		fprintf(stderr, "Failed to write \"%s\".\n", argv[2]);
+		return 1;
+	}
+
+	// Read the file straight back to be sure it holds what was packed.
+	TextureArray packedTextureArray;
+	if (!packedTextureArray.LoadFile(argv[2]) || !(packedTextureArray == textureArray))
+	{
+		fprintf(stderr, "\"%s\" does not read back as it was written.\n", argv[2]);
+		return 1;
+	}
+
+	printf("Packed %d textures of %ux%u with %u mip level(s) into \"%s\".\n", textureArray.GetSliceCount(),
+		textureArray.GetWidth(), textureArray.GetHeight(), textureArray.GetMipCount(), argv[2]);
+	return 0;
+}
\ No newline at end of file
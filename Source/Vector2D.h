@@ -0,0 +1,76 @@
+#pragma once
+
+#include <math.h>
+
+// This is all the vector math the game logic needs.  We use it in place of
+// DirectXMath so that the game model can be built on any platform.
+class Vector2D
+{
+public:
+	Vector2D()
+	{
+		this->x = 0.0f;
+		this->y = 0.0f;
+	}
+
+	Vector2D(float x, float y)
+	{
+		this->x = x;
+		this->y = y;
+	}
+
+	Vector2D operator+(const Vector2D& vector) const
+	{
+		return Vector2D(this->x + vector.x, this->y + vector.y);
+	}
+
+	Vector2D operator-(const Vector2D& vector) const
+	{
+		return Vector2D(this->x - vector.x, this->y - vector.y);
+	}
+
+	Vector2D operator*(float scalar) const
+	{
+		return Vector2D(this->x * scalar, this->y * scalar);
+	}
+
+	Vector2D operator/(float scalar) const
+	{
+		return Vector2D(this->x / scalar, this->y / scalar);
+	}
+
+	void operator+=(const Vector2D& vector)
+	{
+		this->x += vector.x;
+		this->y += vector.y;
+	}
+
+	void operator-=(const Vector2D& vector)
+	{
+		this->x -= vector.x;
+		this->y -= vector.y;
+	}
+
+	void operator*=(float scalar)
+	{
+		this->x *= scalar;
+		this->y *= scalar;
+	}
+
+	bool operator==(const Vector2D& vector) const
+	{
+		return this->x == vector.x && this->y == vector.y;
+	}
+
+	bool operator!=(const Vector2D& vector) const
+	{
+		return !(*this == vector);
+	}
+
+	double Length() const
+	{
+		return ::sqrt(double(this->x) * double(this->x) + double(this->y) * double(this->y));
+	}
+
+	float x, y;
+};
\ No newline at end of file